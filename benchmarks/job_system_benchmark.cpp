@@ -0,0 +1,52 @@
+
+// @NOTE :  Standalone job system benchmark. Doesn't depend on window, renderer
+//          and other platform-specific parts of the engine, so it can be built
+//          on Linux (see linux_build_job_system_benchmark.sh).
+//          Usage : job_system_benchmark [max number of worker threads]
+
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#include "engine/config/engine_config.h"
+#include "engine/debug/debug.h"
+#include "engine/memory/memory_manager.h"
+#include "engine/job_system/job_system.h"
+#include "engine/job_system/job_system_benchmarks.h"
+
+#include "engine/debug/debug.cpp"
+#include "engine/memory/memory_common.cpp"
+#include "engine/memory/memory_manager.cpp"
+#include "engine/memory/pool_allocator.cpp"
+#include "engine/memory/stack_allocator.cpp"
+#include "engine/job_system/job_system_job.cpp"
+#include "engine/job_system/job_system_thread.cpp"
+#include "engine/job_system/job_system_timer_wheel.cpp"
+#include "engine/job_system/job_system.cpp"
+#ifdef _WIN32
+#   include "engine/platform/win32/platform_thread_utilities_win32.cpp"
+#elif defined(__linux__)
+#   include "engine/platform/linux/platform_thread_utilities_linux.cpp"
+#endif
+
+int main(int argc, char** argv)
+{
+    using namespace al::engine;
+    std::size_t maxThreadsNum = std::thread::hardware_concurrency();
+    if (argc > 1)
+    {
+        maxThreadsNum = std::strtoull(argv[1], nullptr, 10);
+    }
+    if (maxThreadsNum == 0)
+    {
+        maxThreadsNum = 1;
+    }
+    MemoryManager::construct_manager();
+    gLogger = MemoryManager::get_stack()->allocate_as<Logger>();
+    construct(gLogger);
+    init_jobs();
+    test::run_job_system_benchmarks(std::cout, maxThreadsNum);
+    destruct(gLogger);
+    MemoryManager::destruct();
+    return 0;
+}
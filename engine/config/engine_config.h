@@ -17,14 +17,15 @@ namespace al::engine
     struct EngineConfig
     {
         // Thread settings
-        static constexpr std::size_t                MAX_SUPPORTED_THREADS { 64 }; // Bigger numbers of threads must be handled differently
+        static constexpr std::size_t                MAX_SUPPORTED_THREADS { 1024 }; // Matches default cpu_set_t size on Linux
+        static constexpr std::size_t                CACHE_LINE_SIZE { 64 };         // Used instead of std::hardware_destructive_interference_size, which is not stable between compiler flags
 
         // Memory Manager settings
         static constexpr const char*                MEMORY_MANAGER_LOG_CATEGORY { "Memory Manager" };
 
-        static constexpr std::size_t                MEMORY_SIZE                         { gigabytes<std::size_t>(1) };
+        static constexpr std::size_t                MEMORY_SIZE                         { gigabytes<std::size_t>(1) + megabytes<std::size_t>(256) };
         static constexpr std::size_t                POOL_ALLOCATOR_MEMORY_SIZE          { megabytes<std::size_t>(800) };
-        static constexpr std::size_t                ECS_POOL_ALLOCATOR_MEMORY_SIZE      { megabytes<std::size_t>(100) };
+        static constexpr std::size_t                ECS_POOL_ALLOCATOR_MEMORY_SIZE      { megabytes<std::size_t>(356) };    // Stores archetype chunks and entity table
         static constexpr std::size_t                POOL_ALLOCATOR_MAX_BUCKETS          { 5 };
         static constexpr std::size_t                POOL_ALLOCATOR_MAX_PTR_SIZE_PAIRS   { 64 };
         static constexpr std::size_t                DEFAULT_MEMORY_ALIGNMENT            { 8 };  // Bytes. Must be power of two
@@ -38,9 +39,16 @@ namespace al::engine
         // Job System settings
         static constexpr const char*                JOB_SYSTEM_LOG_CATEGORY { "Job System" };
 
+        static constexpr std::size_t                IO_JOB_SYSTEM_THREADS   { 2 };      // Threads used for blocking file operations
         static constexpr std::size_t                MAX_JOBS                { 1024 };
         static constexpr std::size_t                MAX_NEXT_JOBS           { 64 };
         static constexpr std::chrono::nanoseconds   JOB_THREAD_SLEEP_TIME   { std::chrono::nanoseconds{ 100000 } }; // 0.1 of millisecond
+        static constexpr std::size_t                JOB_INLINE_PAYLOAD_SIZE             { 320 };    // Bytes. Must be a multiple of cache line size
+        static constexpr std::size_t                JOB_PAYLOAD_OVERFLOW_BLOCK_SIZE     { kilobytes<std::size_t>(4) };
+        static constexpr std::size_t                JOB_PAYLOAD_OVERFLOW_BLOCKS         { 64 };     // Must be power of two
+        static constexpr std::chrono::microseconds  JOB_TIMER_WHEEL_TICK                { std::chrono::microseconds{ 1000 } };
+        static constexpr std::size_t                JOB_TIMER_WHEEL_SLOTS               { 64 };     // Slots per level. Must be power of two
+        static constexpr std::size_t                JOB_TIMER_WHEEL_LEVELS              { 4 };
 
         // Log System settings
         static constexpr const char*                LOG_SYSTEM_LOG_CATEGORY { "Log System" };
@@ -82,10 +90,15 @@ namespace al::engine
         static constexpr const char*                ECS_LOG_CATEGORY { "ECS" };
 
         static constexpr std::size_t                ECS_NUMBER_OF_ELEMENTS_IN_ARCHETYPE_CHUNK   { 64 };
-        static constexpr std::size_t                ECS_MAX_ENTITIES_IN_ARCHETYPE_CHUNK         { 1024 };
-        static constexpr std::size_t                ECS_MAX_ENTITIES                            { 4096 };
-        static constexpr std::size_t                ECS_MAX_ARCHETYPES                          { 1024 };
         static constexpr std::size_t                ECS_COMPONENT_ARRAY_CHUNK_SIZE              { kilobytes<std::size_t>(8) };
+        static constexpr std::size_t                ECS_COMPONENT_ARRAY_ALIGNMENT               { 16 };     // Minimal alignment of component arrays in chunk : 16 (SSE), 32 (AVX) or 64 (AVX-512, cache line)
+        static constexpr std::size_t                ECS_MAX_QUERIES                             { 256 };
+        static constexpr std::size_t                ECS_MAX_OBSERVERS                           { 64 };
+        static constexpr std::size_t                ECS_COMPONENT_FLAGS_BITS                    { 256 };    // Width of archetype component masks : 128, 256, 512 ... Number of component types is one less
+        static constexpr std::size_t                ECS_DESTROY_ENTITIES_BATCH_SIZE             { 64 };     // Number of rows removed from archetype at once by ecs_destroy_entities
+        static constexpr std::size_t                ECS_QUERY_MAX_COMPONENTS                    { 16 };
+        static constexpr std::size_t                ECS_PARALLEL_FOR_EACH_BATCH_SIZE            { 64 };     // Chunk jobs are started in batches of this size
+        static constexpr std::size_t                ECS_PARALLEL_FOR_EACH_MAX_JOBS_IN_FLIGHT    { 256 };    // Must be less than MAX_JOBS
 
         // Scene settings
         static constexpr const char*                SCENE_LOG_CATEGORY { "Scene" };
@@ -42,7 +42,7 @@
 #endif
 
 #ifdef AL_PROFILING_ENABLED
-#   define al_profile_function() ::al::engine::ScopeProfiler __UNIQUE_NAME(profiler)(__FUNCSIG__)
+#   define al_profile_function() ::al::engine::ScopeProfiler __UNIQUE_NAME(profiler)(al_function_signature)
 #   define al_profile_scope(name) ::al::engine::ScopeProfiler __UNIQUE_NAME(profiler)(name)
 #else
 #   define al_profile_function()
@@ -51,6 +51,10 @@
 
 #ifdef _MSC_VER
 #   define al_debug_break __debugbreak
+#   define al_function_signature __FUNCSIG__
+#elif defined(__GNUC__)
+#   define al_debug_break __builtin_trap
+#   define al_function_signature __PRETTY_FUNCTION__
 #else
 #   error Unsupported platform
 #endif
@@ -58,14 +62,14 @@
 #define al_assert(cond)                                                                     \
     if (!(cond))                                                                            \
     {                                                                                       \
-        ::al::engine::assert_implementation(__FILE__, __FUNCSIG__, __LINE__, #cond); \
+        ::al::engine::assert_implementation(__FILE__, al_function_signature, __LINE__, #cond); \
     }
 
 #define al_assert_msg(cond, format, ...)                                                    \
     if (!(cond))                                                                            \
     {                                                                                       \
         al_log_error("assert", format, __VA_ARGS__);                                        \
-        ::al::engine::assert_implementation(__FILE__, __FUNCSIG__, __LINE__, #cond); \
+        ::al::engine::assert_implementation(__FILE__, al_function_signature, __LINE__, #cond); \
     }
 
 #define al_crash_impl std::abort();
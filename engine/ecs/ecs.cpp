@@ -1,5 +1,7 @@
 
 #include <inttypes.h>
+#include <algorithm>    // for std::sort, std::unique, std::binary_search
+#include <type_traits>  // for std::is_trivially_copyable_v
 
 #include "ecs.h"
 
@@ -11,342 +13,2766 @@
 
 namespace al::engine
 {
-    // @NOTE :  Component count starts with number one, not zero.
-    //          This is done because ECS system thinks that component array
-    //          with componentId == 0 is not used (see ecs_is_valid_component_array).
-    //          We could use additional bool value (isValid or something), but
-    //          currently this is not very neccessary.
-    EcsComponentId              gEcsComponentCount = 1;
+    std::atomic<uint64_t>       gEcsComponentTypeHashes[ECS_WORLD_MAX_COMPONENTS] = { };
     EcsComponentRuntimeInfo     gEcsComponentInfos[ECS_WORLD_MAX_COMPONENTS] = { };
 
+    // @NOTE :  Per-type cache of component id (ECS_WORLD_MAX_COMPONENTS until the type is registered).
+    //          It is constant-initialized, so unlike function-local static it is read without initialization guard.
+    template<typename T>
+    std::atomic<EcsComponentId> gEcsComponentIdCache{ ECS_WORLD_MAX_COMPONENTS };
+
+    // @NOTE :  Number of additional owners of each ecs pool block (archetype chunk, entity page or sparse set position page),
+    //          see ecs_create_snapshot.
+    //          Zero means that block is owned by a single world and can be written in place.
+    std::atomic<uint32_t> gEcsBlockReferences[EngineConfig::ECS_POOL_ALLOCATOR_MEMORY_SIZE / EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE];
+
+    static_assert(is_power_of_two(ECS_WORLD_ARCHETYPE_LOOKUP_INITIAL_SIZE), "Archetype lookup table size must be power of two");
+    static_assert(is_power_of_two(EngineConfig::ECS_COMPONENT_ARRAY_ALIGNMENT), "Component array alignment must be power of two");
+    // @NOTE :  Chunks are aligned by the ecs pool allocator (see MemoryBucket::initialize)
+    static_assert(EngineConfig::ECS_COMPONENT_ARRAY_ALIGNMENT <= minimum(lowest_set_bit(EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE), EngineConfig::CACHE_LINE_SIZE), "Component array alignment is bigger than chunk alignment");
+
     void construct(EcsWorld* world)
     {
-        construct(&world->entities);
+        construct(&world->entityPages);
+        world->entitiesNum = 0;
+        world->freeEntitiesHead = ECS_WORLD_INVALID_ENTITY_INDEX;
         construct(&world->archetypes);
-        for (EcsSizeT it = 0; it < EngineConfig::ECS_MAX_ARCHETYPES; it++)
+        construct(&world->archetypeMasks);
+        world->archetypeLookupSize = ECS_WORLD_ARCHETYPE_LOOKUP_INITIAL_SIZE;
+        world->archetypeLookup = reinterpret_cast<EcsArchetypeHandle*>(MemoryManager::get_pool()->allocate(sizeof(EcsArchetypeHandle) * world->archetypeLookupSize));
+        for (EcsSizeT it = 0; it < world->archetypeLookupSize; it++)
+        {
+            world->archetypeLookup[it] = ECS_WORLD_EMPTY_ARCHETYPE;
+        }
+        construct(&world->queries);
+        world->changeVersion = 1;
+        for (EcsSizeT it = 0; it < ECS_WORLD_MAX_COMPONENTS; it++)
+        {
+            world->singletons[it] = nullptr;
+            world->sparseSets[it] = nullptr;
+        }
+        construct(&world->sparseComponentIds);
+        world->snapshot = { nullptr, 0, nullptr };
+        construct(&world->observers);
+        for (EcsComponentFlags& flags : world->observedComponents)
         {
-            // @NOTE :  Set each archetype to the correct areas of the pools
-            EcsArchetype* archetype = get(&world->archetypes, it);
-            construct(&archetype->componentArrayPointers, &world->componentArrayPointersPool[it * ECS_WORLD_MAX_COMPONENTS]);
-            construct(&archetype->entityHandles         , &world->entityHandlesPool[it * EngineConfig::ECS_MAX_ENTITIES_IN_ARCHETYPE_CHUNK]);
-            construct(&archetype->chunks);
-            archetype->selfHandle = it;
+            flags = { };
         }
+        construct(&world->observerEvents);
+        world->isFlushingObservers = false;
         // @NOTE :  Setup first empty archetype
-        EcsArchetype* archetype = push(&world->archetypes);
-        archetype->componentFlags   = { };
-        archetype->size             = 0;
-        archetype->capacity         = 0;
-        archetype->selfHandle       = 0;
+        ecs_create_archetype(world, { });
     }
 
     void destruct(EcsWorld* world)
     {
-        for_each_array_container(world->archetypes, archetypeIt)
+        al_assert_msg(world->queries.size == 0, "All queries must be destructed before the world");
+        for_each_dynamic_array(world->archetypes, archetypeIt)
         {
-            EcsArchetype* archetype = get(&world->archetypes, archetypeIt);
+            EcsArchetype* archetype = ecs_get_archetype(world, archetypeIt);
             for_each_dynamic_array(archetype->chunks, chunkIt)
             {
                 uint8_t* chunk = *get(&archetype->chunks, chunkIt);
-                MemoryManager::get_ecs_pool()->deallocate(reinterpret_cast<std::byte*>(chunk), EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE);
+                if (!ecs_is_snapshot_memory(world, chunk))
+                {
+                    ecs_release_block(chunk);
+                }
             }
             destruct(&archetype->chunks);
+            destruct(&archetype->chunkVersions);
+            if (archetype->sharedComponents)
+            {
+                MemoryManager::get_pool()->deallocate(reinterpret_cast<std::byte*>(archetype->sharedComponents), archetype->sharedComponentsSize);
+            }
+            destruct(&archetype->addEdges);
+            MemoryManager::get_pool()->deallocate(reinterpret_cast<std::byte*>(archetype), ecs_get_archetype_allocation_size(archetype->componentsNum));
+        }
+        destruct(&world->archetypes);
+        destruct(&world->archetypeMasks);
+        for_each_dynamic_array(world->entityPages, it)
+        {
+            EcsEntity* page = *get(&world->entityPages, it);
+            if (!ecs_is_snapshot_memory(world, page))
+            {
+                ecs_release_block(page);
+            }
+        }
+        destruct(&world->entityPages);
+        MemoryManager::get_pool()->deallocate(reinterpret_cast<std::byte*>(world->archetypeLookup), sizeof(EcsArchetypeHandle) * world->archetypeLookupSize);
+        for (EcsSizeT it = 0; it < ECS_WORLD_MAX_COMPONENTS; it++)
+        {
+            if (world->singletons[it])
+            {
+                MemoryManager::get_pool()->deallocate(reinterpret_cast<std::byte*>(world->singletons[it]), gEcsComponentInfos[it].sizeBytes);
+            }
+        }
+        for_each_dynamic_array(world->sparseComponentIds, it)
+        {
+            EcsSparseSet* set = ecs_get_sparse_set(world, *get(&world->sparseComponentIds, it));
+            for_each_dynamic_array(set->pages, pageIt)
+            {
+                uint32_t* page = *get(&set->pages, pageIt);
+                if (page)
+                {
+                    ecs_release_block(page);
+                }
+            }
+            destruct(&set->pages);
+            destruct(&set->handles);
+            destruct(&set->components);
+            MemoryManager::get_pool()->deallocate(reinterpret_cast<std::byte*>(set), sizeof(EcsSparseSet));
+        }
+        destruct(&world->sparseComponentIds);
+        platform_unmap_file(&world->snapshot);
+        destruct(&world->observerEvents);
+    }
+
+    EcsEntityHandle ecs_create_entity(EcsWorld* world)
+    {
+        // @NOTE :  Indices of destroyed entities are reused first. Generation of the entity
+        //          was already incremented on destruction, so old handles stay invalid.
+        if (world->freeEntitiesHead != ECS_WORLD_INVALID_ENTITY_INDEX)
+        {
+            const uint32_t index = world->freeEntitiesHead;
+            EcsEntity* entity = ecs_get_writable_entity_by_index(world, index);
+            world->freeEntitiesHead = entity->nextFreeIndex;
+            entity->archetypeHandle = ECS_WORLD_EMPTY_ARCHETYPE;
+            entity->archetypeArrayIndex = 0;
+            entity->nextFreeIndex = ECS_WORLD_INVALID_ENTITY_INDEX;
+            return ecs_make_entity_handle(index, entity->generation);
+        }
+        al_assert_msg(world->entitiesNum < ECS_WORLD_INVALID_ENTITY_INDEX, "Can't create new entity : all entity indices are used")
+        if (world->entitiesNum == world->entityPages.size * ECS_WORLD_ENTITIES_IN_PAGE)
+        {
+            std::byte* page = MemoryManager::get_ecs_pool()->allocate(EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE);
+            al_assert_msg(page, "Can't create new entity : ecs pool is out of memory. Consider increasing EngineConfig::ECS_POOL_ALLOCATOR_MEMORY_SIZE value.")
+            push(&world->entityPages, reinterpret_cast<EcsEntity*>(page));
+        }
+        const uint32_t index = static_cast<uint32_t>(world->entitiesNum++);
+        *ecs_get_writable_entity_by_index(world, index) =
+        {
+            .archetypeHandle = ECS_WORLD_EMPTY_ARCHETYPE,
+            .archetypeArrayIndex = 0,
+            .generation = 0,
+            .nextFreeIndex = ECS_WORLD_INVALID_ENTITY_INDEX
+        };
+        return ecs_make_entity_handle(index, 0);
+    }
+
+    void ecs_destroy_entity(EcsWorld* world, EcsEntityHandle handle)
+    {
+        EcsEntity* entity = ecs_get_entity(world, handle);
+        ecs_record_observer_events(world, EcsObserverEvent::REMOVE, ecs_get_archetype(world, entity->archetypeHandle)->componentFlags, { &handle, 1 });
+        ecs_free_position(world, entity->archetypeHandle, entity->archetypeArrayIndex);
+        ecs_sparse_remove_entity(world, handle);
+        ecs_release_entity(world, handle);
+    }
+
+    // @NOTE :  Destroyed entities are grouped by archetype and each group is removed with
+    //          ecs_free_positions, which compacts archetype in a single pass. Handles must be unique.
+    void ecs_destroy_entities(EcsWorld* world, std::span<const EcsEntityHandle> handles)
+    {
+        EcsSizeT indices[EngineConfig::ECS_DESTROY_ENTITIES_BATCH_SIZE];
+        ecs_for_each_archetype_run(world, handles, [world, &indices](EcsArchetypeHandle archetype, std::span<const EcsEntityHandle> run)
+        {
+            for (EcsSizeT batchBegin = 0; batchBegin < run.size(); batchBegin += EngineConfig::ECS_DESTROY_ENTITIES_BATCH_SIZE)
+            {
+                const std::span<const EcsEntityHandle> batch = run.subspan(batchBegin, minimum(run.size() - batchBegin, EngineConfig::ECS_DESTROY_ENTITIES_BATCH_SIZE));
+                ecs_record_observer_events(world, EcsObserverEvent::REMOVE, ecs_get_archetype(world, archetype)->componentFlags, batch);
+                for (EcsSizeT it = 0; it < batch.size(); it++)
+                {
+                    indices[it] = ecs_get_entity(world, batch[it])->archetypeArrayIndex;
+                }
+                ecs_free_positions(world, archetype, std::span<EcsSizeT>{ indices, batch.size() });
+                for (EcsEntityHandle handle : batch)
+                {
+                    ecs_sparse_remove_entity(world, handle);
+                    ecs_release_entity(world, handle);
+                }
+            }
+        });
+    }
+
+    bool ecs_is_entity_alive(EcsWorld* world, EcsEntityHandle handle)
+    {
+        const uint32_t index = ecs_get_entity_handle_index(handle);
+        return index < world->entitiesNum && ecs_get_entity_by_index(world, index)->generation == ecs_get_entity_handle_generation(handle);
+    }
+
+    void ecs_create_entities(EcsWorld* world, EcsArchetypeHandle archetype, std::span<EcsEntityHandle> handles)
+    {
+        // @NOTE :  Rows for all entities are reserved at once and component arrays
+        //          are cleared with a single memset per column and chunk
+        const EcsComponentFlags flags = ecs_get_archetype(world, archetype)->chunkComponentFlags;
+        const EcsSizeT firstIndex = ecs_reserve_positions(world, archetype, handles.size());
+        for (EcsSizeT it = 0; it < handles.size(); it++)
+        {
+            const EcsEntityHandle handle = ecs_create_entity(world);
+            EcsEntity* entity = ecs_get_writable_entity(world, handle);
+            entity->archetypeHandle = archetype;
+            entity->archetypeArrayIndex = archetype == ECS_WORLD_EMPTY_ARCHETYPE ? 0 : firstIndex + it;
+            if (archetype != ECS_WORLD_EMPTY_ARCHETYPE)
+            {
+                *ecs_access_entity_handle(ecs_get_archetype(world, archetype), firstIndex + it) = handle;
+            }
+            handles[it] = handle;
+        }
+        ecs_zero_components(world, archetype, flags, firstIndex, handles.size());
+        ecs_record_observer_events(world, EcsObserverEvent::ADD, ecs_get_archetype(world, archetype)->componentFlags, handles);
+    }
+
+    template<typename ... T>
+    void ecs_create_entities(EcsWorld* world, std::span<EcsEntityHandle> handles)
+    {
+        ecs_register_components_if_needed<T...>();
+        ecs_create_entities(world, ecs_follow_add_edges<T...>(world, ECS_WORLD_EMPTY_ARCHETYPE), handles);
+        if constexpr (ecs_has_sparse_components<T...>())
+        {
+            for (EcsEntityHandle handle : handles)
+            {
+                ecs_add_sparse_components<T...>(world, handle);
+            }
+        }
+    }
+
+    template<typename ... T>
+    void ecs_add_components(EcsWorld* world, std::span<const EcsEntityHandle> handles)
+    {
+        ecs_register_components_if_needed<T...>();
+        ecs_for_each_archetype_run(world, handles, [world](EcsArchetypeHandle from, std::span<const EcsEntityHandle> run)
+        {
+            const EcsArchetypeHandle to = ecs_follow_add_edges<T...>(world, from);
+            if (from != to)
+            {
+                ecs_move_entities(world, from, to, run);
+            }
+        });
+        if constexpr (ecs_has_sparse_components<T...>())
+        {
+            for (EcsEntityHandle handle : handles)
+            {
+                ecs_add_sparse_components<T...>(world, handle);
+            }
+        }
+    }
+
+    template<typename ... T>
+    void ecs_remove_components(EcsWorld* world, std::span<const EcsEntityHandle> handles)
+    {
+        ecs_register_components_if_needed<T...>();
+        ecs_for_each_archetype_run(world, handles, [world](EcsArchetypeHandle from, std::span<const EcsEntityHandle> run)
+        {
+            const EcsArchetypeHandle to = ecs_follow_remove_edges<T...>(world, from);
+            if (from != to)
+            {
+                ecs_move_entities(world, from, to, run);
+            }
+        });
+        if constexpr (ecs_has_sparse_components<T...>())
+        {
+            for (EcsEntityHandle handle : handles)
+            {
+                ecs_remove_sparse_components<T...>(world, handle);
+            }
+        }
+    }
+
+    template<typename ... T>
+    void ecs_add_components (EcsWorld* world, EcsEntityHandle handle)
+    {
+        ecs_register_components_if_needed<T...>();
+        ecs_add_sparse_components<T...>(world, handle);
+        EcsEntity* entity = ecs_get_entity(world, handle);
+        EcsArchetypeHandle oldArchetype = entity->archetypeHandle;
+        EcsArchetypeHandle newArchetype = ecs_follow_add_edges<T...>(world, oldArchetype);
+        if (oldArchetype == newArchetype)
+        {
+            return;
+        }
+        ecs_move_entity_superset(world, oldArchetype, newArchetype, handle);
+    }
+
+    template<typename ... T>
+    void ecs_remove_components(EcsWorld* world, EcsEntityHandle handle)
+    {
+        ecs_register_components_if_needed<T...>();
+        ecs_remove_sparse_components<T...>(world, handle);
+        EcsEntity* entity = ecs_get_entity(world, handle);
+        EcsArchetypeHandle oldArchetype = entity->archetypeHandle;
+        EcsArchetypeHandle newArchetype = ecs_follow_remove_edges<T...>(world, oldArchetype);
+        if (oldArchetype == newArchetype)
+        {
+            return;
+        }
+        ecs_move_entity_subset(world, oldArchetype, newArchetype, handle);
+    }
+
+    template<typename T>
+    T* ecs_get_component(EcsWorld* world, EcsEntityHandle handle)
+    {
+        if constexpr (ecs_component_type_info_get_storage<T>() == EcsComponentStorage::SPARSE)
+        {
+            return reinterpret_cast<T*>(ecs_sparse_get(world, ecs_component_type_info_get_id<T>(), handle));
+        }
+        else
+        {
+            EcsEntity* entity = ecs_get_entity(world, handle);
+            EcsArchetype* archetype = ecs_get_archetype(world, entity->archetypeHandle);
+            // @NOTE :  Component is marked before access, because marking can replace shared chunk with it's copy
+            if (archetype->componentFlags.get_flag(ecs_component_type_info_get_id<T>()))
+            {
+                ecs_mark_component_changed<T>(world, archetype, entity->archetypeArrayIndex / archetype->singleChunkCapacity);
+            }
+            return reinterpret_cast<T*>(ecs_access_component(world, entity->archetypeHandle, ecs_component_type_info_get_id<T>(), entity->archetypeArrayIndex));
+        }
+    }
+
+    template<typename ... T>
+    void ecs_for_each_fp(EcsWorld* world, EcsForEachFunctionPointer<T...> func)
+    {
+        EcsComponentFlags requestFlags{ };
+        ecs_set_component_flags<T...>(&requestFlags);
+        if constexpr (ecs_has_sparse_components<T...>())
+        {
+            const EcsArchetypeFilter filter{ requestFlags, { }, { } };
+            ecs_for_each_sparse<T...>(world, &filter, &func);
+        }
+        else
+        {
+            for_each_dynamic_array(world->archetypes, it)
+            {
+                EcsArchetype* archetype = ecs_get_archetype(world, it);
+                if (!ecs_is_valid_subset(requestFlags, archetype->componentFlags))
+                {
+                    continue;
+                }
+                for (EcsSizeT chunkIt = 0; chunkIt * archetype->singleChunkCapacity < archetype->size; chunkIt++)
+                {
+                    ecs_for_each_in_chunk<T...>(world, archetype, chunkIt, &func);
+                }
+            }
+        }
+    }
+
+    template<typename ... T>
+    void ecs_for_each(EcsWorld* world, EcsForEachFunctionObject<T...> func)
+    {
+        EcsComponentFlags requestFlags{ };
+        ecs_set_component_flags<T...>(&requestFlags);
+        if constexpr (ecs_has_sparse_components<T...>())
+        {
+            const EcsArchetypeFilter filter{ requestFlags, { }, { } };
+            ecs_for_each_sparse<T...>(world, &filter, &func);
+        }
+        else
+        {
+            for_each_dynamic_array(world->archetypes, it)
+            {
+                EcsArchetype* archetype = ecs_get_archetype(world, it);
+                if (!ecs_is_valid_subset(requestFlags, archetype->componentFlags))
+                {
+                    continue;
+                }
+                for (EcsSizeT chunkIt = 0; chunkIt * archetype->singleChunkCapacity < archetype->size; chunkIt++)
+                {
+                    ecs_for_each_in_chunk<T...>(world, archetype, chunkIt, &func);
+                }
+            }
+        }
+    }
+
+    template<typename ... T>
+    void ecs_for_each_parallel(EcsWorld* world, JobSystem* jobSystem, EcsForEachFunctionObject<T...> func)
+    {
+        using Payload = EcsForEachChunkJobPayload<T...>;
+        static_assert(!ecs_has_sparse_components<T...>(), "Sparse components can't be used in parallel for each");
+        static_assert(EngineConfig::ECS_PARALLEL_FOR_EACH_MAX_JOBS_IN_FLIGHT < EngineConfig::MAX_JOBS, "Parallel for each can't use all jobs");
+        static_assert(EngineConfig::ECS_PARALLEL_FOR_EACH_BATCH_SIZE <= EngineConfig::ECS_PARALLEL_FOR_EACH_MAX_JOBS_IN_FLIGHT, "Parallel for each batch is too big");
+        EcsComponentFlags requestFlags{ };
+        ecs_set_component_flags<T...>(&requestFlags);
+        std::atomic<EcsSizeT> finishedJobsNum{ 0 };
+        EcsSizeT startedJobsNum = 0;
+        Job* batch[EngineConfig::ECS_PARALLEL_FOR_EACH_BATCH_SIZE];
+        EcsSizeT batchSize = 0;
+        for_each_dynamic_array(world->archetypes, it)
+        {
+            EcsArchetype* archetype = ecs_get_archetype(world, it);
+            if (archetype->size == 0 || !ecs_is_valid_subset(requestFlags, archetype->componentFlags))
+            {
+                continue;
+            }
+            const EcsSizeT chunksNum = (archetype->size + archetype->singleChunkCapacity - 1) / archetype->singleChunkCapacity;
+            for (EcsSizeT chunkIt = 0; chunkIt < chunksNum; chunkIt++)
+            {
+                Job* job = get_job(jobSystem);
+                configure(job, [](Job* job)
+                {
+                    Payload* payload = get_payload<Payload>(job);
+                    ecs_for_each_in_chunk<T...>(payload->world, payload->archetype, payload->chunkIndex, payload->func);
+                    payload->finishedJobsNum->fetch_add(1, std::memory_order_release);
+                });
+                emplace_payload<Payload>(job, world, archetype, chunkIt, &func, &finishedJobsNum);
+                batch[batchSize++] = job;
+                if (batchSize == EngineConfig::ECS_PARALLEL_FOR_EACH_BATCH_SIZE)
+                {
+                    start_jobs(jobSystem, { batch, batchSize });
+                    startedJobsNum += batchSize;
+                    batchSize = 0;
+                    // @NOTE :  Job pool is shared by all job systems, so number of jobs in flight is limited
+                    constexpr EcsSizeT MAX_STARTED_JOBS = EngineConfig::ECS_PARALLEL_FOR_EACH_MAX_JOBS_IN_FLIGHT - EngineConfig::ECS_PARALLEL_FOR_EACH_BATCH_SIZE;
+                    if (startedJobsNum > MAX_STARTED_JOBS)
+                    {
+                        ecs_dispatch_jobs_until(jobSystem, &finishedJobsNum, startedJobsNum - MAX_STARTED_JOBS);
+                    }
+                }
+            }
+        }
+        if (batchSize)
+        {
+            start_jobs(jobSystem, { batch, batchSize });
+            startedJobsNum += batchSize;
+        }
+        ecs_dispatch_jobs_until(jobSystem, &finishedJobsNum, startedJobsNum);
+    }
+
+    template<typename ... F, typename ... T>
+    void construct(EcsQuery<T...>* query, EcsWorld* world)
+    {
+        static_assert(sizeof...(T) <= EngineConfig::ECS_QUERY_MAX_COMPONENTS, "Too many query components. Consider increasing EngineConfig::ECS_QUERY_MAX_COMPONENTS value.");
+        static_assert(!((EcsQueryTermTraits<T>::IS_OPTIONAL && ecs_has_sparse_components<T>()) || ...), "Optional query components can't be sparse");
+        ecs_register_components_if_needed<EcsQueryTermType<T>...>();
+        EcsQueryState* state = &query->state;
+        state->filter = { };
+        ((EcsQueryTermTraits<T>::IS_OPTIONAL ? void() : ecs_set_component_flags<EcsQueryTermType<T>>(&state->filter.allFlags)), ...);
+        (ecs_apply_query_filter(state, F{ }), ...);
+        const EcsComponentId componentIds[] = { ecs_component_type_info_get_id<EcsQueryTermType<T>>()... };
+        for (EcsSizeT it = 0; it < sizeof...(T); it++)
+        {
+            state->componentIds[it] = componentIds[it];
+        }
+        state->componentsNum = sizeof...(T);
+        construct(&state->archetypes);
+        state->changedFilterMask = 0;
+        state->lastRunVersion = 0;
+        ecs_register_query(world, state);
+    }
+
+    template<typename ... T>
+    void destruct(EcsQuery<T...>* query, EcsWorld* world)
+    {
+        ecs_unregister_query(world, &query->state);
+        destruct(&query->state.archetypes);
+    }
+
+    template<typename ... U, typename ... T>
+    void ecs_set_changed_filter(EcsQuery<T...>* query)
+    {
+        static_assert(!ecs_has_sparse_components<T...>(), "Changed filter can't be used with sparse components");
+        EcsQueryState* state = &query->state;
+        state->changedFilterMask = 0;
+        const EcsComponentId filterIds[] = { ecs_component_type_info_get_id<U>()... };
+        for (EcsComponentId filterId : filterIds)
+        {
+            EcsSizeT position = 0;
+            while (position < state->componentsNum && state->componentIds[position] != filterId)
+            {
+                position++;
+            }
+            al_assert_msg(position < state->componentsNum, "Changed filter component %" PRIu64 " is not a query component", filterId)
+            state->changedFilterMask |= EcsSizeT{ 1 } << position;
+        }
+    }
+
+    template<typename T>
+    T* ecs_get_singleton(EcsWorld* world)
+    {
+        ecs_register_components_if_needed<T>();
+        return reinterpret_cast<T*>(world->singletons[ecs_component_type_info_get_id<T>()]);
+    }
+
+    template<typename T>
+    T* ecs_set_singleton(EcsWorld* world, const T& value)
+    {
+        static_assert(ecs_component_type_info_get_storage<T>() != EcsComponentStorage::TAG, "Tags can't be singletons");
+        static_assert(std::is_trivially_copyable_v<T>, "Singletons are copied with memcpy, so they must be trivially copyable");
+        ecs_register_components_if_needed<T>();
+        uint8_t** singleton = &world->singletons[ecs_component_type_info_get_id<T>()];
+        if (!*singleton)
+        {
+            *singleton = reinterpret_cast<uint8_t*>(MemoryManager::get_pool()->allocate(sizeof(T)));
+            al_assert_msg(*singleton, "Can't create singleton : pool allocator is out of memory.")
+        }
+        std::memcpy(*singleton, &value, sizeof(T));
+        return reinterpret_cast<T*>(*singleton);
+    }
+
+    template<typename T>
+    void ecs_remove_singleton(EcsWorld* world)
+    {
+        uint8_t** singleton = &world->singletons[ecs_component_type_info_get_id<T>()];
+        if (*singleton)
+        {
+            MemoryManager::get_pool()->deallocate(reinterpret_cast<std::byte*>(*singleton), sizeof(T));
+            *singleton = nullptr;
+        }
+    }
+
+    template<typename T>
+    void ecs_add_observer(EcsWorld* world, EcsObserverEvent event, EcsObserverFunctionPointer func, void* userData)
+    {
+        ecs_register_components_if_needed<T>();
+        ecs_add_observer(world, ecs_component_type_info_get_id<T>(), event, func, userData);
+    }
+
+    template<typename T>
+    void ecs_remove_observer(EcsWorld* world, EcsObserverEvent event, EcsObserverFunctionPointer func, void* userData)
+    {
+        ecs_remove_observer(world, ecs_component_type_info_get_id<T>(), event, func, userData);
+    }
+
+    // @NOTE :  Observers can make structural changes, so events are flushed until no new events are recorded.
+    //          Nested calls from observers return right away, their events are delivered by the outer call.
+    void ecs_flush_observers(EcsWorld* world)
+    {
+        if (world->isFlushingObservers)
+        {
+            return;
+        }
+        world->isFlushingObservers = true;
+        DynamicArray<EcsObserverEventRecord> events;
+        DynamicArray<EcsEntityHandle> handles;
+        construct(&events);
+        construct(&handles);
+        while (world->observerEvents.size)
+        {
+            std::swap(events, world->observerEvents);
+            // @NOTE :  Events are grouped by component and event type, recording order is kept inside each group
+            std::stable_sort(events.memory, events.memory + events.size, [](const EcsObserverEventRecord& first, const EcsObserverEventRecord& second) -> bool
+            {
+                return first.componentId != second.componentId ? first.componentId < second.componentId : first.event < second.event;
+            });
+            for (EcsSizeT groupBegin = 0; groupBegin < events.size; )
+            {
+                const EcsComponentId componentId = get(&events, groupBegin)->componentId;
+                const EcsObserverEvent event = get(&events, groupBegin)->event;
+                handles.size = 0;
+                for (; groupBegin < events.size && get(&events, groupBegin)->componentId == componentId && get(&events, groupBegin)->event == event; groupBegin++)
+                {
+                    push(&handles, get(&events, groupBegin)->handle);
+                }
+                for_each_array_container(world->observers, it)
+                {
+                    const EcsObserver observer = *get(&world->observers, it);
+                    if (observer.componentId == componentId && observer.event == event)
+                    {
+                        observer.func(world, std::span<const EcsEntityHandle>{ handles.memory, handles.size }, observer.userData);
+                    }
+                }
+            }
+            events.size = 0;
+        }
+        destruct(&events);
+        destruct(&handles);
+        world->isFlushingObservers = false;
+    }
+
+    template<typename ... T>
+    void ecs_for_each_fp(EcsWorld* world, EcsQuery<T...>* query, EcsForEachFunctionPointer<EcsQueryTermType<T>...> func)
+    {
+        if constexpr (ecs_has_sparse_components<T...>())
+        {
+            ecs_for_each_sparse<T...>(world, &query->state.filter, &func);
+        }
+        else
+        {
+            for_each_dynamic_array(query->state.archetypes, it)
+            {
+                ecs_for_each_in_query_archetype<T...>(world, &query->state, get(&query->state.archetypes, it), &func, std::index_sequence_for<T...>{ });
+            }
+        }
+        ecs_finish_query_iteration(world, &query->state);
+    }
+
+    template<typename ... T>
+    void ecs_for_each(EcsWorld* world, EcsQuery<T...>* query, EcsForEachFunctionObject<EcsQueryTermType<T>...> func)
+    {
+        if constexpr (ecs_has_sparse_components<T...>())
+        {
+            ecs_for_each_sparse<T...>(world, &query->state.filter, &func);
+        }
+        else
+        {
+            for_each_dynamic_array(query->state.archetypes, it)
+            {
+                ecs_for_each_in_query_archetype<T...>(world, &query->state, get(&query->state.archetypes, it), &func, std::index_sequence_for<T...>{ });
+            }
+        }
+        ecs_finish_query_iteration(world, &query->state);
+    }
+
+    template<typename ... T>
+    void ecs_for_each_chunk_fp(EcsWorld* world, EcsForEachChunkFunctionPointer<T...> func)
+    {
+        ecs_for_each_chunk_matching<T...>(world, &func);
+    }
+
+    template<typename ... T>
+    void ecs_for_each_chunk(EcsWorld* world, EcsForEachChunkFunctionObject<T...> func)
+    {
+        ecs_for_each_chunk_matching<T...>(world, &func);
+    }
+
+    template<typename ... T>
+    void ecs_for_each_chunk_fp(EcsWorld* world, EcsQuery<T...>* query, EcsForEachChunkFunctionPointer<EcsQueryTermType<T>...> func)
+    {
+        ecs_for_each_chunk_in_query<T...>(world, query, &func);
+    }
+
+    template<typename ... T>
+    void ecs_for_each_chunk(EcsWorld* world, EcsQuery<T...>* query, EcsForEachChunkFunctionObject<EcsQueryTermType<T>...> func)
+    {
+        ecs_for_each_chunk_in_query<T...>(world, query, &func);
+    }
+
+    EcsEntity* ecs_get_entity(EcsWorld* world, EcsEntityHandle handle)
+    {
+        const uint32_t index = ecs_get_entity_handle_index(handle);
+        al_assert_msg(index < world->entitiesNum, "Invalid entity handle : index %" PRIu32 " is out of range", index)
+        EcsEntity* entity = ecs_get_entity_by_index(world, index);
+        al_assert_msg(entity->generation == ecs_get_entity_handle_generation(handle), "Stale entity handle : entity %" PRIu32 " was destroyed", index)
+        return entity;
+    }
+
+    EcsEntity* ecs_get_entity_by_index(EcsWorld* world, EcsSizeT index)
+    {
+        return *get(&world->entityPages, index / ECS_WORLD_ENTITIES_IN_PAGE) + index % ECS_WORLD_ENTITIES_IN_PAGE;
+    }
+
+    EcsArchetype* ecs_get_archetype(EcsWorld* world, EcsArchetypeHandle handle)
+    {
+        return world->archetypes.memory[handle];
+    }
+
+    bool ecs_is_snapshot_memory(EcsWorld* world, const void* memory)
+    {
+        const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(memory);
+        const std::uintptr_t snapshotBegin = reinterpret_cast<std::uintptr_t>(world->snapshot.memory);
+        return address >= snapshotBegin && address < snapshotBegin + world->snapshot.size;
+    }
+
+    // @NOTE :  Moves entity pages and chunks of the mapped snapshot file to the ecs pool and unmaps the file
+    void ecs_copy_snapshot_memory(EcsWorld* world)
+    {
+        auto copyBlock = [world](auto** block)
+        {
+            if (!ecs_is_snapshot_memory(world, *block))
+            {
+                return;
+            }
+            std::byte* copy = MemoryManager::get_ecs_pool()->allocate(EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE);
+            al_assert_msg(copy, "Can't copy snapshot memory : ecs pool is out of memory. Consider increasing EngineConfig::ECS_POOL_ALLOCATOR_MEMORY_SIZE value.")
+            std::memcpy(copy, *block, EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE);
+            *block = reinterpret_cast<std::remove_pointer_t<decltype(block)>>(copy);
+        };
+        for_each_dynamic_array(world->entityPages, it)
+        {
+            copyBlock(get(&world->entityPages, it));
+        }
+        for_each_dynamic_array(world->archetypes, archetypeIt)
+        {
+            EcsArchetype* archetype = ecs_get_archetype(world, archetypeIt);
+            for_each_dynamic_array(archetype->chunks, it)
+            {
+                copyBlock(get(&archetype->chunks, it));
+            }
+        }
+        platform_unmap_file(&world->snapshot);
+    }
+
+    std::atomic<uint32_t>* ecs_get_block_references(const void* block)
+    {
+        const std::byte* poolMemory = get(&MemoryManager::get_ecs_pool()->get_buckets(), 0)->get_memory();
+        const EcsSizeT index = static_cast<EcsSizeT>(static_cast<const std::byte*>(block) - poolMemory) / EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE;
+        al_assert_msg(index < sizeof(gEcsBlockReferences) / sizeof(gEcsBlockReferences[0]), "Block doesn't belong to the ecs pool")
+        return &gEcsBlockReferences[index];
+    }
+
+    // @NOTE :  Block is returned to the ecs pool by it's last owner
+    void ecs_release_block(void* block)
+    {
+        std::atomic<uint32_t>* references = ecs_get_block_references(block);
+        uint32_t referencesNum = references->load(std::memory_order_acquire);
+        while (referencesNum && !references->compare_exchange_weak(referencesNum, referencesNum - 1, std::memory_order_acq_rel)) { }
+        if (!referencesNum)
+        {
+            MemoryManager::get_ecs_pool()->deallocate(reinterpret_cast<std::byte*>(block), EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE);
+        }
+    }
+
+    std::byte* ecs_get_writable_block(EcsWorld* world, std::byte* block)
+    {
+        if (ecs_is_snapshot_memory(world, block) || !ecs_get_block_references(block)->load(std::memory_order_acquire))
+        {
+            return block;
+        }
+        std::byte* copy = MemoryManager::get_ecs_pool()->allocate(EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE);
+        al_assert_msg(copy, "Can't copy shared block : ecs pool is out of memory. Consider increasing EngineConfig::ECS_POOL_ALLOCATOR_MEMORY_SIZE value.")
+        std::memcpy(copy, block, EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE);
+        ecs_release_block(block);
+        return copy;
+    }
+
+    uint8_t* ecs_get_writable_chunk(EcsWorld* world, EcsArchetype* archetype, EcsSizeT chunkIndex)
+    {
+        uint8_t** chunk = get(&archetype->chunks, chunkIndex);
+        *chunk = reinterpret_cast<uint8_t*>(ecs_get_writable_block(world, reinterpret_cast<std::byte*>(*chunk)));
+        return *chunk;
+    }
+
+    EcsEntity* ecs_get_writable_entity(EcsWorld* world, EcsEntityHandle handle)
+    {
+        ecs_get_entity(world, handle);
+        return ecs_get_writable_entity_by_index(world, ecs_get_entity_handle_index(handle));
+    }
+
+    EcsEntity* ecs_get_writable_entity_by_index(EcsWorld* world, EcsSizeT index)
+    {
+        EcsEntity** page = get(&world->entityPages, index / ECS_WORLD_ENTITIES_IN_PAGE);
+        *page = reinterpret_cast<EcsEntity*>(ecs_get_writable_block(world, reinterpret_cast<std::byte*>(*page)));
+        return *page + index % ECS_WORLD_ENTITIES_IN_PAGE;
+    }
+
+    void ecs_add_observer(EcsWorld* world, EcsComponentId componentId, EcsObserverEvent event, EcsObserverFunctionPointer func, void* userData)
+    {
+        const EcsObserver* observer = push(&world->observers, EcsObserver{ func, userData, componentId, event });
+        al_assert_msg(observer, "Can't add observer : maximum number of observers is reached. Consider increasing EngineConfig::ECS_MAX_OBSERVERS value.")
+        world->observedComponents[static_cast<EcsSizeT>(event)].set_flag(componentId);
+    }
+
+    void ecs_remove_observer(EcsWorld* world, EcsComponentId componentId, EcsObserverEvent event, EcsObserverFunctionPointer func, void* userData)
+    {
+        al_assert_msg(!world->isFlushingObservers, "Observers can't be removed while observers are flushed")
+        bool isObserved = false;
+        for (EcsSizeT it = 0; it < world->observers.size; )
+        {
+            const EcsObserver* observer = get(&world->observers, it);
+            if (observer->componentId == componentId && observer->event == event)
+            {
+                if (observer->func == func && observer->userData == userData)
+                {
+                    remove(&world->observers, it);
+                    continue;
+                }
+                isObserved = true;
+            }
+            it++;
+        }
+        if (!isObserved)
+        {
+            world->observedComponents[static_cast<EcsSizeT>(event)].clear_flag(componentId);
+        }
+    }
+
+    void ecs_record_observer_event(EcsWorld* world, EcsObserverEvent event, EcsComponentId componentId, EcsEntityHandle handle)
+    {
+        if (world->observedComponents[static_cast<EcsSizeT>(event)].get_flag(componentId))
+        {
+            push(&world->observerEvents, EcsObserverEventRecord{ handle, componentId, event });
+        }
+    }
+
+    void ecs_record_observer_events(EcsWorld* world, EcsObserverEvent event, EcsComponentFlags flags, std::span<const EcsEntityHandle> handles)
+    {
+        const EcsComponentFlags observedFlags = flags & world->observedComponents[static_cast<EcsSizeT>(event)];
+        if (observedFlags.is_empty())
+        {
+            return;
+        }
+        for_each_set_flag(observedFlags, componentIt)
+        {
+            for (EcsEntityHandle handle : handles)
+            {
+                push(&world->observerEvents, EcsObserverEventRecord{ handle, componentIt, event });
+            }
+        }
+    }
+
+    // @NOTE :  Invalidates handle and pushes entity index to the free list.
+    //          Entity must already be removed from it's archetype.
+    void ecs_release_entity(EcsWorld* world, EcsEntityHandle handle)
+    {
+        const uint32_t index = ecs_get_entity_handle_index(handle);
+        EcsEntity* entity = ecs_get_writable_entity_by_index(world, index);
+        entity->archetypeHandle = ECS_WORLD_EMPTY_ARCHETYPE;
+        entity->archetypeArrayIndex = 0;
+        // @NOTE :  Generation wraps around before reaching ECS_PENDING_ENTITY_GENERATION
+        entity->generation = entity->generation + 1 == ECS_PENDING_ENTITY_GENERATION ? 0 : entity->generation + 1;
+        entity->nextFreeIndex = world->freeEntitiesHead;
+        world->freeEntitiesHead = index;
+    }
+
+    void construct(EcsCommandBuffer* buffer)
+    {
+        construct(&buffer->commands);
+        construct(&buffer->data);
+        buffer->createdEntitiesNum = 0;
+    }
+
+    void destruct(EcsCommandBuffer* buffer)
+    {
+        destruct(&buffer->commands);
+        destruct(&buffer->data);
+    }
+
+    EcsEntityHandle ecs_create_entity(EcsCommandBuffer* buffer)
+    {
+        const EcsEntityHandle handle = ecs_make_entity_handle(static_cast<uint32_t>(buffer->createdEntitiesNum++), ECS_PENDING_ENTITY_GENERATION);
+        ecs_push_command(buffer, EcsCommandType::CREATE, handle);
+        return handle;
+    }
+
+    void ecs_destroy_entity(EcsCommandBuffer* buffer, EcsEntityHandle handle)
+    {
+        ecs_push_command(buffer, EcsCommandType::DESTROY, handle);
+    }
+
+    template<typename ... T>
+    void ecs_add_components(EcsCommandBuffer* buffer, EcsEntityHandle handle)
+    {
+        ecs_register_components_if_needed<T...>();
+        EcsComponentFlags flags{ };
+        EcsComponentFlags sparseFlags{ };
+        ecs_set_component_flags<T...>(&flags);
+        ecs_set_sparse_component_flags<T...>(&sparseFlags);
+        ecs_push_command(buffer, EcsCommandType::ADD, handle, flags, sparseFlags);
+    }
+
+    template<typename ... T>
+    void ecs_remove_components(EcsCommandBuffer* buffer, EcsEntityHandle handle)
+    {
+        ecs_register_components_if_needed<T...>();
+        EcsComponentFlags flags{ };
+        EcsComponentFlags sparseFlags{ };
+        ecs_set_component_flags<T...>(&flags);
+        ecs_set_sparse_component_flags<T...>(&sparseFlags);
+        ecs_push_command(buffer, EcsCommandType::REMOVE, handle, flags, sparseFlags);
+    }
+
+    template<typename T>
+    void ecs_set_component(EcsCommandBuffer* buffer, EcsEntityHandle handle, const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Components are copied with memcpy, so they must be trivially copyable");
+        ecs_register_components_if_needed<T>();
+        ecs_push_command(buffer, EcsCommandType::SET, handle);
+        EcsCommand* command = get(&buffer->commands, buffer->commands.size - 1);
+        command->componentId = ecs_component_type_info_get_id<T>();
+        command->dataOffset = buffer->data.size;
+        ecs_push_command_data(buffer, &value, sizeof(T));
+    }
+
+    void ecs_execute_command_buffers(EcsWorld* world, std::span<EcsCommandBuffer*> buffers)
+    {
+        struct EntityChange
+        {
+            EcsEntityHandle     handle;
+            EcsSizeT            order;      // Changes of each entity must be applied in recording order
+            EcsCommandType      type;
+            EcsComponentFlags   flags;
+            EcsComponentFlags   sparseFlags;
+        };
+        struct EntityMove
+        {
+            EcsArchetypeHandle  from;
+            EcsArchetypeHandle  to;
+            EcsEntityHandle     handle;
+        };
+        DynamicArray<EcsEntityHandle>   createdEntities;
+        DynamicArray<EcsEntityHandle>   destroyedEntities;
+        DynamicArray<EntityChange>      changes;
+        DynamicArray<EntityMove>        moves;
+        construct(&createdEntities);
+        construct(&destroyedEntities);
+        construct(&changes);
+        construct(&moves);
+        // @NOTE :  Create all entities at once in the empty archetype. Pending handles of buffer are
+        //          resolved to createdEntities[createdOffsets[buffer] + pending handle index].
+        EcsSizeT createdEntitiesNum = 0;
+        for (EcsCommandBuffer* buffer : buffers)
+        {
+            createdEntitiesNum += buffer->createdEntitiesNum;
+        }
+        expand(&createdEntities, createdEntitiesNum);
+        createdEntities.size = createdEntitiesNum;
+        ecs_create_entities(world, ECS_WORLD_EMPTY_ARCHETYPE, std::span<EcsEntityHandle>{ createdEntities.memory, createdEntitiesNum });
+        EcsSizeT createdOffset = 0;
+        EcsSizeT order = 0;
+        for (EcsCommandBuffer* buffer : buffers)
+        {
+            for_each_dynamic_array(buffer->commands, it)
+            {
+                EcsCommand* command = get(&buffer->commands, it);
+                if (ecs_get_entity_handle_generation(command->handle) == ECS_PENDING_ENTITY_GENERATION)
+                {
+                    al_assert(ecs_get_entity_handle_index(command->handle) < buffer->createdEntitiesNum);
+                    command->handle = *get(&createdEntities, createdOffset + ecs_get_entity_handle_index(command->handle));
+                }
+                if (command->type == EcsCommandType::DESTROY)
+                {
+                    push(&destroyedEntities, command->handle);
+                }
+                else if (command->type == EcsCommandType::ADD || command->type == EcsCommandType::REMOVE)
+                {
+                    push(&changes, { command->handle, order++, command->type, command->componentFlags, command->sparseComponentFlags });
+                }
+            }
+            createdOffset += buffer->createdEntitiesNum;
+        }
+        // @NOTE :  Entity might be destroyed by several buffers
+        std::sort(destroyedEntities.memory, destroyedEntities.memory + destroyedEntities.size);
+        destroyedEntities.size = std::unique(destroyedEntities.memory, destroyedEntities.memory + destroyedEntities.size) - destroyedEntities.memory;
+        auto isDestroyed = [&destroyedEntities](EcsEntityHandle handle) -> bool
+        {
+            return std::binary_search(destroyedEntities.memory, destroyedEntities.memory + destroyedEntities.size, handle);
+        };
+        // @NOTE :  Merge all changes of each entity into the final component flags
+        std::sort(changes.memory, changes.memory + changes.size, [](const EntityChange& first, const EntityChange& second) -> bool
+        {
+            return first.handle != second.handle ? first.handle < second.handle : first.order < second.order;
+        });
+        for (EcsSizeT changeIt = 0; changeIt < changes.size; )
+        {
+            const EcsEntityHandle handle = get(&changes, changeIt)->handle;
+            EcsEntity* entity = ecs_get_entity(world, handle);
+            const EcsComponentFlags entityFlags = ecs_get_archetype(world, entity->archetypeHandle)->componentFlags;
+            EcsComponentFlags flags = entityFlags;
+            for (; changeIt < changes.size && get(&changes, changeIt)->handle == handle; changeIt++)
+            {
+                const EntityChange* change = get(&changes, changeIt);
+                // @NOTE :  Sparse components don't move entity, so they are added and removed right away
+                ecs_sparse_apply_flags(world, handle, change->sparseFlags, change->type == EcsCommandType::ADD);
+                flags = change->type == EcsCommandType::ADD ? flags | change->flags : flags & ~change->flags;
+            }
+            if (flags == entityFlags || isDestroyed(handle))
+            {
+                continue;
+            }
+            push(&moves, { entity->archetypeHandle, ecs_find_or_create_archetype(world, flags), handle });
+        }
+        std::sort(moves.memory, moves.memory + moves.size, [](const EntityMove& first, const EntityMove& second) -> bool
+        {
+            return first.to != second.to ? first.to < second.to : first.from < second.from;
+        });
+        // @NOTE :  ecs_move_entities takes contiguous array of handles
+        DynamicArray<EcsEntityHandle> movedEntities;
+        construct(&movedEntities);
+        expand(&movedEntities, moves.size);
+        for_each_dynamic_array(moves, it)
+        {
+            push(&movedEntities, get(&moves, it)->handle);
+        }
+        for (EcsSizeT runBegin = 0; runBegin < moves.size; )
+        {
+            const EntityMove* move = get(&moves, runBegin);
+            EcsSizeT runEnd = runBegin + 1;
+            while (runEnd < moves.size && get(&moves, runEnd)->from == move->from && get(&moves, runEnd)->to == move->to)
+            {
+                runEnd++;
+            }
+            ecs_move_entities(world, move->from, move->to, std::span<const EcsEntityHandle>{ movedEntities.memory + runBegin, runEnd - runBegin });
+            runBegin = runEnd;
+        }
+        for (EcsCommandBuffer* buffer : buffers)
+        {
+            for_each_dynamic_array(buffer->commands, it)
+            {
+                const EcsCommand* command = get(&buffer->commands, it);
+                if (command->type != EcsCommandType::SET || isDestroyed(command->handle))
+                {
+                    continue;
+                }
+                const EcsEntity* entity = ecs_get_entity(world, command->handle);
+                const bool isSparse = gEcsComponentInfos[command->componentId].storage == EcsComponentStorage::SPARSE;
+                EcsArchetype* archetype = ecs_get_archetype(world, entity->archetypeHandle);
+                if (!isSparse && archetype->componentFlags.get_flag(command->componentId))
+                {
+                    ecs_mark_component_changed(world, archetype, entity->archetypeArrayIndex / archetype->singleChunkCapacity, command->componentId);
+                }
+                uint8_t* component = isSparse
+                    ? ecs_sparse_get(world, command->componentId, command->handle)
+                    : ecs_access_component(world, entity->archetypeHandle, command->componentId, entity->archetypeArrayIndex);
+                al_assert_msg(component, "Can't set component %" PRIu64 " : entity doesn't have this component", command->componentId)
+                ecs_record_observer_event(world, EcsObserverEvent::SET, command->componentId, command->handle);
+                std::memcpy(component, get(&buffer->data, command->dataOffset), gEcsComponentInfos[command->componentId].sizeBytes);
+            }
+            ecs_clear(buffer);
+        }
+        // @NOTE :  Group destroyed entities by archetype, so each archetype is compacted once
+        std::sort(destroyedEntities.memory, destroyedEntities.memory + destroyedEntities.size, [world](EcsEntityHandle first, EcsEntityHandle second) -> bool
+        {
+            return ecs_get_entity(world, first)->archetypeHandle < ecs_get_entity(world, second)->archetypeHandle;
+        });
+        ecs_destroy_entities(world, std::span<const EcsEntityHandle>{ destroyedEntities.memory, destroyedEntities.size });
+        destruct(&movedEntities);
+        destruct(&moves);
+        destruct(&changes);
+        destruct(&destroyedEntities);
+        destruct(&createdEntities);
+        ecs_flush_observers(world);
+    }
+
+    bool ecs_save_snapshot(EcsWorld* world, const char* path)
+    {
+        constexpr EcsSizeT CHUNK_SIZE = EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE;
+        constexpr EcsSizeT DATA_ALIGNMENT = sizeof(uint64_t);
+        // @NOTE :  Records are collected first, so offsets of all sections are known before writing
+        DynamicArray<EcsSnapshotArchetype> archetypes;
+        DynamicArray<EcsSnapshotComponent> components;
+        DynamicArray<EcsSnapshotSparseSet> sparseSets;
+        DynamicArray<EcsSnapshotSingleton> singletons;
+        construct(&archetypes);
+        construct(&components);
+        construct(&sparseSets);
+        construct(&singletons);
+        EcsSizeT chunksNum = 0;
+        EcsSizeT dataSize = 0;
+        for (EcsSizeT archetypeIt = 1; archetypeIt < world->archetypes.size; archetypeIt++)
+        {
+            EcsArchetype* archetype = ecs_get_archetype(world, archetypeIt);
+            push(&archetypes, EcsSnapshotArchetype{ archetype->size, archetype->singleChunkCapacity, chunksNum, archetype->chunks.size, components.size, archetype->componentsNum });
+            chunksNum += archetype->chunks.size;
+            EcsSizeT componentIndex = 0;
+            for_each_set_flag(archetype->componentFlags, it)
+            {
+                const EcsComponentRuntimeInfo* info = &gEcsComponentInfos[it];
+                EcsSnapshotComponent record{ info->typeHash, info->sizeBytes, static_cast<EcsSizeT>(info->storage), archetype->componentArrayPointers[componentIndex++] };
+                if (info->storage == EcsComponentStorage::SHARED)
+                {
+                    record.offset = dataSize;
+                    dataSize += align_up(info->sizeBytes, DATA_ALIGNMENT);
+                }
+                push(&components, record);
+            }
+        }
+        for_each_dynamic_array(world->sparseComponentIds, it)
+        {
+            const EcsComponentId componentId = *get(&world->sparseComponentIds, it);
+            EcsSparseSet* set = ecs_get_sparse_set(world, componentId);
+            EcsSnapshotSparseSet record{ gEcsComponentInfos[componentId].typeHash, set->sizeBytes, set->handles.size, dataSize, 0 };
+            dataSize += sizeof(EcsEntityHandle) * set->handles.size;
+            record.componentsOffset = dataSize;
+            dataSize += align_up(EcsSizeT{ set->components.size }, DATA_ALIGNMENT);
+            push(&sparseSets, record);
+        }
+        for (EcsSizeT it = 0; it < ECS_WORLD_MAX_COMPONENTS; it++)
+        {
+            if (world->singletons[it])
+            {
+                push(&singletons, EcsSnapshotSingleton{ gEcsComponentInfos[it].typeHash, gEcsComponentInfos[it].sizeBytes, dataSize });
+                dataSize += align_up(gEcsComponentInfos[it].sizeBytes, DATA_ALIGNMENT);
+            }
+        }
+        EcsSnapshotHeader header{ };
+        header.magic                = ECS_SNAPSHOT_MAGIC;
+        header.version              = ECS_SNAPSHOT_VERSION;
+        header.chunkSize            = static_cast<uint32_t>(CHUNK_SIZE);
+        header.entitySize           = sizeof(EcsEntity);
+        header.entitiesNum          = world->entitiesNum;
+        header.freeEntitiesHead     = world->freeEntitiesHead;
+        header.changeVersion        = world->changeVersion;
+        header.entityPagesNum       = world->entityPages.size;
+        header.archetypesNum        = archetypes.size;
+        header.componentsNum        = components.size;
+        header.sparseSetsNum        = sparseSets.size;
+        header.singletonsNum        = singletons.size;
+        header.archetypesOffset     = sizeof(EcsSnapshotHeader);
+        header.componentsOffset     = header.archetypesOffset + sizeof(EcsSnapshotArchetype) * archetypes.size;
+        header.sparseSetsOffset     = header.componentsOffset + sizeof(EcsSnapshotComponent) * components.size;
+        header.singletonsOffset     = header.sparseSetsOffset + sizeof(EcsSnapshotSparseSet) * sparseSets.size;
+        header.dataOffset           = header.singletonsOffset + sizeof(EcsSnapshotSingleton) * singletons.size;
+        header.entityPagesOffset    = align_up(header.dataOffset + dataSize, CHUNK_SIZE);
+        header.chunksOffset         = header.entityPagesOffset + CHUNK_SIZE * world->entityPages.size;
+        header.fileSize             = header.chunksOffset + CHUNK_SIZE * chunksNum;
+        std::FILE* file = std::fopen(path, "wb");
+        bool result = file != nullptr;
+        EcsSizeT fileOffset = 0;
+        result = result && ecs_snapshot_write(file, &fileOffset, &header, sizeof(EcsSnapshotHeader));
+        result = result && ecs_snapshot_write(file, &fileOffset, archetypes.memory, sizeof(EcsSnapshotArchetype) * archetypes.size);
+        result = result && ecs_snapshot_write(file, &fileOffset, components.memory, sizeof(EcsSnapshotComponent) * components.size);
+        result = result && ecs_snapshot_write(file, &fileOffset, sparseSets.memory, sizeof(EcsSnapshotSparseSet) * sparseSets.size);
+        result = result && ecs_snapshot_write(file, &fileOffset, singletons.memory, sizeof(EcsSnapshotSingleton) * singletons.size);
+        for (EcsSizeT archetypeIt = 0; result && archetypeIt < archetypes.size; archetypeIt++)
+        {
+            EcsArchetype* archetype = ecs_get_archetype(world, archetypeIt + 1);
+            const EcsSnapshotArchetype* record = get(&archetypes, archetypeIt);
+            for (EcsSizeT it = 0; result && it < record->componentsNum; it++)
+            {
+                const EcsSnapshotComponent* component = get(&components, record->firstComponent + it);
+                if (component->storage == static_cast<EcsSizeT>(EcsComponentStorage::SHARED))
+                {
+                    result = result && ecs_snapshot_pad(file, &fileOffset, header.dataOffset + component->offset);
+                    result = result && ecs_snapshot_write(file, &fileOffset, archetype->sharedComponents + archetype->componentArrayPointers[it], component->sizeBytes);
+                }
+            }
+        }
+        for (EcsSizeT it = 0; result && it < sparseSets.size; it++)
+        {
+            EcsSparseSet* set = ecs_get_sparse_set(world, *get(&world->sparseComponentIds, it));
+            result = result && ecs_snapshot_pad(file, &fileOffset, header.dataOffset + get(&sparseSets, it)->handlesOffset);
+            result = result && ecs_snapshot_write(file, &fileOffset, set->handles.memory, sizeof(EcsEntityHandle) * set->handles.size);
+            result = result && ecs_snapshot_pad(file, &fileOffset, header.dataOffset + get(&sparseSets, it)->componentsOffset);
+            result = result && ecs_snapshot_write(file, &fileOffset, set->components.memory, set->components.size);
+        }
+        for (EcsSizeT it = 0, singletonIt = 0; result && it < ECS_WORLD_MAX_COMPONENTS; it++)
+        {
+            if (world->singletons[it])
+            {
+                result = result && ecs_snapshot_pad(file, &fileOffset, header.dataOffset + get(&singletons, singletonIt++)->dataOffset);
+                result = result && ecs_snapshot_write(file, &fileOffset, world->singletons[it], gEcsComponentInfos[it].sizeBytes);
+            }
+        }
+        result = result && ecs_snapshot_pad(file, &fileOffset, header.entityPagesOffset);
+        for_each_dynamic_array(world->entityPages, it)
+        {
+            result = result && ecs_snapshot_write(file, &fileOffset, *get(&world->entityPages, it), CHUNK_SIZE);
+        }
+        for (EcsSizeT archetypeIt = 1; result && archetypeIt < world->archetypes.size; archetypeIt++)
+        {
+            EcsArchetype* archetype = ecs_get_archetype(world, archetypeIt);
+            for_each_dynamic_array(archetype->chunks, it)
+            {
+                result = result && ecs_snapshot_write(file, &fileOffset, *get(&archetype->chunks, it), CHUNK_SIZE);
+            }
+        }
+        if (file)
+        {
+            result = std::fclose(file) == 0 && result;
+        }
+        destruct(&archetypes);
+        destruct(&components);
+        destruct(&sparseSets);
+        destruct(&singletons);
+        return result;
+    }
+
+    bool ecs_load_snapshot(EcsWorld* world, const char* path)
+    {
+        al_assert_msg(world->entitiesNum == 0 && world->archetypes.size == 1 && !world->snapshot.memory, "Snapshot can be loaded only into a newly constructed world")
+        FileMapping mapping;
+        if (!platform_map_file(&mapping, path))
+        {
+            return false;
+        }
+        if (!ecs_validate_snapshot(mapping.memory, mapping.size))
+        {
+            platform_unmap_file(&mapping);
+            return false;
+        }
+        world->snapshot = mapping;
+        const EcsSnapshotHeader* header = reinterpret_cast<const EcsSnapshotHeader*>(mapping.memory);
+        const std::byte* data = mapping.memory + header->dataOffset;
+        world->entitiesNum = header->entitiesNum;
+        world->freeEntitiesHead = static_cast<uint32_t>(header->freeEntitiesHead);
+        world->changeVersion = header->changeVersion;
+        for (EcsSizeT it = 0; it < header->entityPagesNum; it++)
+        {
+            push(&world->entityPages, reinterpret_cast<EcsEntity*>(mapping.memory + header->entityPagesOffset + EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE * it));
+        }
+        const EcsSnapshotArchetype* archetypes = reinterpret_cast<const EcsSnapshotArchetype*>(mapping.memory + header->archetypesOffset);
+        for (EcsSizeT it = 0; it < header->archetypesNum; it++)
+        {
+            // @NOTE :  Entities store archetype handles, so archetypes must be created in the stored order.
+            //          Masks of stored archetypes are unique (see ecs_validate_snapshot),
+            //          so each record creates a new archetype with handle it + 1
+            ecs_load_snapshot_archetype(world, &archetypes[it]);
+        }
+        const EcsSnapshotSparseSet* sparseSets = reinterpret_cast<const EcsSnapshotSparseSet*>(mapping.memory + header->sparseSetsOffset);
+        for (EcsSizeT it = 0; it < header->sparseSetsNum; it++)
+        {
+            EcsSparseSet* set = ecs_get_or_create_sparse_set(world, ecs_find_component_id(sparseSets[it].typeHash));
+            const EcsEntityHandle* handles = reinterpret_cast<const EcsEntityHandle*>(data + sparseSets[it].handlesOffset);
+            ecs_fill_sparse_set(set, handles, reinterpret_cast<const uint8_t*>(data + sparseSets[it].componentsOffset), sparseSets[it].size);
+            for (EcsSizeT entityIt = 0; entityIt < sparseSets[it].size; entityIt++)
+            {
+                *ecs_access_sparse_position(world, set, ecs_get_entity_handle_index(handles[entityIt]), true) = static_cast<uint32_t>(entityIt);
+            }
+        }
+        const EcsSnapshotSingleton* singletons = reinterpret_cast<const EcsSnapshotSingleton*>(mapping.memory + header->singletonsOffset);
+        for (EcsSizeT it = 0; it < header->singletonsNum; it++)
+        {
+            uint8_t** singleton = &world->singletons[ecs_find_component_id(singletons[it].typeHash)];
+            *singleton = reinterpret_cast<uint8_t*>(MemoryManager::get_pool()->allocate(singletons[it].sizeBytes));
+            al_assert_msg(*singleton, "Can't load singleton : pool allocator is out of memory.")
+            std::memcpy(*singleton, data + singletons[it].dataOffset, singletons[it].sizeBytes);
+        }
+        return true;
+    }
+
+    void ecs_create_snapshot(EcsWorld* world, EcsWorld* snapshot)
+    {
+        al_assert_msg(snapshot->entitiesNum == 0 && snapshot->archetypes.size == 1 && !snapshot->snapshot.memory, "Snapshot can be created only in a newly constructed world")
+        if (world->snapshot.memory)
+        {
+            ecs_copy_snapshot_memory(world);
+        }
+        snapshot->entitiesNum = world->entitiesNum;
+        snapshot->freeEntitiesHead = world->freeEntitiesHead;
+        snapshot->changeVersion = world->changeVersion;
+        for_each_dynamic_array(world->entityPages, it)
+        {
+            EcsEntity* page = *get(&world->entityPages, it);
+            ecs_get_block_references(page)->fetch_add(1, std::memory_order_relaxed);
+            push(&snapshot->entityPages, page);
+        }
+        for (EcsArchetypeHandle archetypeIt = 1; archetypeIt < world->archetypes.size; archetypeIt++)
+        {
+            EcsArchetype* archetype = ecs_get_archetype(world, archetypeIt);
+            const EcsArchetypeHandle handle = ecs_create_archetype(snapshot, archetype->componentFlags);
+            al_assert(handle == archetypeIt);
+            EcsArchetype* snapshotArchetype = ecs_get_archetype(snapshot, handle);
+            for_each_dynamic_array(archetype->chunks, it)
+            {
+                uint8_t* chunk = *get(&archetype->chunks, it);
+                ecs_get_block_references(chunk)->fetch_add(1, std::memory_order_relaxed);
+                push(&snapshotArchetype->chunks, chunk);
+            }
+            for_each_dynamic_array(archetype->chunkVersions, it)
+            {
+                push(&snapshotArchetype->chunkVersions, *get(&archetype->chunkVersions, it));
+            }
+            if (archetype->sharedComponentsSize)
+            {
+                std::memcpy(snapshotArchetype->sharedComponents, archetype->sharedComponents, archetype->sharedComponentsSize);
+            }
+            snapshotArchetype->size = archetype->size;
+            snapshotArchetype->capacity = archetype->capacity;
+        }
+        for_each_dynamic_array(world->sparseComponentIds, it)
+        {
+            const EcsComponentId componentId = *get(&world->sparseComponentIds, it);
+            EcsSparseSet* set = ecs_get_sparse_set(world, componentId);
+            EcsSparseSet* snapshotSet = ecs_get_or_create_sparse_set(snapshot, componentId);
+            ecs_fill_sparse_set(snapshotSet, set->handles.memory, set->components.memory, set->handles.size);
+            // @NOTE :  Dense positions are the same in both sets, so position pages are shared (same as entity pages)
+            for_each_dynamic_array(set->pages, pageIt)
+            {
+                uint32_t* page = *get(&set->pages, pageIt);
+                if (page)
+                {
+                    ecs_get_block_references(page)->fetch_add(1, std::memory_order_relaxed);
+                }
+                push(&snapshotSet->pages, page);
+            }
+        }
+        for (EcsSizeT it = 0; it < ECS_WORLD_MAX_COMPONENTS; it++)
+        {
+            if (world->singletons[it])
+            {
+                snapshot->singletons[it] = reinterpret_cast<uint8_t*>(MemoryManager::get_pool()->allocate(gEcsComponentInfos[it].sizeBytes));
+                al_assert_msg(snapshot->singletons[it], "Can't copy singleton : pool allocator is out of memory.")
+                std::memcpy(snapshot->singletons[it], world->singletons[it], gEcsComponentInfos[it].sizeBytes);
+            }
+        }
+    }
+
+    bool ecs_snapshot_write(std::FILE* file, EcsSizeT* fileOffset, const void* data, EcsSizeT size)
+    {
+        *fileOffset += size;
+        return size == 0 || std::fwrite(data, 1, size, file) == size;
+    }
+
+    bool ecs_snapshot_pad(std::FILE* file, EcsSizeT* fileOffset, EcsSizeT targetOffset)
+    {
+        static const uint8_t ZEROS[256] = { };
+        bool result = true;
+        while (result && *fileOffset < targetOffset)
+        {
+            result = ecs_snapshot_write(file, fileOffset, ZEROS, minimum(targetOffset - *fileOffset, EcsSizeT{ sizeof(ZEROS) }));
+        }
+        return result;
+    }
+
+    // @NOTE :  Checks everything the loaded world relies on before the world is changed, so loading either succeeds
+    //          or leaves the world untouched : file bounds of all records, components and chunk layouts of archetypes,
+    //          archetype positions and free list of stored entities, handles of sparse sets and uniqueness of
+    //          archetype masks, sparse sets and singletons. Counts are checked against file size before they are
+    //          multiplied and offsets are checked with isInRange, so crafted values can't overflow the checks.
+    bool ecs_validate_snapshot(const std::byte* file, EcsSizeT fileSize)
+    {
+        constexpr EcsSizeT CHUNK_SIZE = EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE;
+        const EcsSnapshotHeader* header = reinterpret_cast<const EcsSnapshotHeader*>(file);
+        if (fileSize < sizeof(EcsSnapshotHeader) || header->magic != ECS_SNAPSHOT_MAGIC || header->version != ECS_SNAPSHOT_VERSION ||
+            header->chunkSize != CHUNK_SIZE || header->entitySize != sizeof(EcsEntity) || header->fileSize != fileSize ||
+            header->entityPagesNum > fileSize / CHUNK_SIZE || header->archetypesNum > fileSize || header->componentsNum > fileSize ||
+            header->sparseSetsNum > fileSize || header->singletonsNum > fileSize || header->entityPagesOffset > fileSize ||
+            header->entityPagesOffset % CHUNK_SIZE != 0 || header->chunksOffset != header->entityPagesOffset + CHUNK_SIZE * header->entityPagesNum ||
+            header->chunksOffset > fileSize || header->entitiesNum > header->entityPagesNum * ECS_WORLD_ENTITIES_IN_PAGE ||
+            header->archetypesOffset != sizeof(EcsSnapshotHeader) ||
+            header->componentsOffset != header->archetypesOffset + sizeof(EcsSnapshotArchetype) * header->archetypesNum ||
+            header->sparseSetsOffset != header->componentsOffset + sizeof(EcsSnapshotComponent) * header->componentsNum ||
+            header->singletonsOffset != header->sparseSetsOffset + sizeof(EcsSnapshotSparseSet) * header->sparseSetsNum ||
+            header->dataOffset != header->singletonsOffset + sizeof(EcsSnapshotSingleton) * header->singletonsNum ||
+            header->dataOffset > header->entityPagesOffset)
+        {
+            return false;
+        }
+        const EcsSizeT dataSize = header->entityPagesOffset - header->dataOffset;
+        auto isInRange = [](EcsSizeT offset, EcsSizeT size, EcsSizeT limit) -> bool
+        {
+            return offset <= limit && size <= limit - offset;
+        };
+        auto isMatchingComponent = [](uint64_t typeHash, EcsSizeT sizeBytes, EcsComponentStorage storage) -> bool
+        {
+            const EcsComponentId componentId = ecs_find_component_id(typeHash);
+            return componentId != ECS_WORLD_MAX_COMPONENTS && gEcsComponentInfos[componentId].sizeBytes == sizeBytes && gEcsComponentInfos[componentId].storage == storage;
+        };
+        const EcsSizeT chunksNum = (fileSize - header->chunksOffset) / CHUNK_SIZE;
+        const EcsSnapshotArchetype* archetypes = reinterpret_cast<const EcsSnapshotArchetype*>(file + header->archetypesOffset);
+        const EcsSnapshotComponent* components = reinterpret_cast<const EcsSnapshotComponent*>(file + header->componentsOffset);
+        for (EcsSizeT it = 0; it < header->componentsNum; it++)
+        {
+            const EcsComponentStorage storage = static_cast<EcsComponentStorage>(components[it].storage);
+            if (components[it].storage > static_cast<EcsSizeT>(EcsComponentStorage::SPARSE) || storage == EcsComponentStorage::SPARSE ||
+                !isMatchingComponent(components[it].typeHash, components[it].sizeBytes, storage) ||
+                (storage == EcsComponentStorage::SHARED && !isInRange(components[it].offset, components[it].sizeBytes, dataSize)))
+            {
+                return false;
+            }
+        }
+        // @NOTE :  Archetype handles are assigned in the stored order, so each record must create a new archetype :
+        //          masks must be unique and not empty (empty mask is the empty archetype) and can't repeat components.
+        //          Chunk columns must fit into the chunk, because archetype with different layout is copied row by row.
+        DynamicArray<EcsComponentFlags> masks;
+        construct(&masks);
+        bool isValid = true;
+        for (EcsSizeT it = 0; isValid && it < header->archetypesNum; it++)
+        {
+            const EcsSnapshotArchetype* archetype = &archetypes[it];
+            isValid = isInRange(archetype->firstChunk, archetype->chunksNum, chunksNum) && isInRange(archetype->firstComponent, archetype->componentsNum, header->componentsNum) &&
+                archetype->componentsNum != 0 && archetype->singleChunkCapacity != 0 && archetype->singleChunkCapacity <= CHUNK_SIZE / sizeof(EcsEntityHandle) &&
+                archetype->size <= archetype->chunksNum * archetype->singleChunkCapacity;
+            EcsComponentFlags mask{ };
+            for (EcsSizeT componentIt = 0; isValid && componentIt < archetype->componentsNum; componentIt++)
+            {
+                const EcsSnapshotComponent* component = &components[archetype->firstComponent + componentIt];
+                const EcsComponentId componentId = ecs_find_component_id(component->typeHash);
+                isValid = !mask.get_flag(componentId) && (static_cast<EcsComponentStorage>(component->storage) != EcsComponentStorage::CHUNK ||
+                    isInRange(component->offset, component->sizeBytes * archetype->singleChunkCapacity, CHUNK_SIZE));
+                mask.set_flag(componentId);
+            }
+            push(&masks, mask);
+        }
+        if (isValid)
+        {
+            std::sort(masks.memory, masks.memory + masks.size, [](const EcsComponentFlags& first, const EcsComponentFlags& second) -> bool
+            {
+                return std::lexicographical_compare(first.flags, first.flags + EcsComponentFlags::WORDS_NUM, second.flags, second.flags + EcsComponentFlags::WORDS_NUM);
+            });
+            isValid = std::adjacent_find(masks.memory, masks.memory + masks.size) == masks.memory + masks.size;
+        }
+        destruct(&masks);
+        if (!isValid)
+        {
+            return false;
+        }
+        // @NOTE :  Entities are checked one by one, so validation time depends on the number of entities.
+        //          Destroyed entities are in the empty archetype, so only alive ones are checked against archetype size.
+        auto getEntity = [file, header](EcsSizeT index) -> const EcsEntity*
+        {
+            const std::byte* page = file + header->entityPagesOffset + CHUNK_SIZE * (index / ECS_WORLD_ENTITIES_IN_PAGE);
+            return reinterpret_cast<const EcsEntity*>(page) + index % ECS_WORLD_ENTITIES_IN_PAGE;
+        };
+        auto isValidFreeIndex = [header](EcsSizeT index) -> bool
+        {
+            return index == ECS_WORLD_INVALID_ENTITY_INDEX || index < header->entitiesNum;
+        };
+        if (!isValidFreeIndex(header->freeEntitiesHead))
+        {
+            return false;
+        }
+        for (EcsSizeT it = 0; it < header->entitiesNum; it++)
+        {
+            const EcsEntity* entity = getEntity(it);
+            if (entity->archetypeHandle > header->archetypesNum || !isValidFreeIndex(entity->nextFreeIndex) ||
+                (entity->archetypeHandle != ECS_WORLD_EMPTY_ARCHETYPE && entity->archetypeArrayIndex >= archetypes[entity->archetypeHandle - 1].size))
+            {
+                return false;
+            }
+        }
+        // @NOTE :  Free list can contain only entities of the empty archetype (entities with rows are alive) and list
+        //          which is longer than entity table has a cycle. Alive entities of the empty archetype don't own rows
+        //          and are stored exactly as free ones, so they can't be told apart here.
+        EcsSizeT freeEntitiesNum = 0;
+        for (EcsSizeT index = header->freeEntitiesHead; index != ECS_WORLD_INVALID_ENTITY_INDEX; index = getEntity(index)->nextFreeIndex)
+        {
+            freeEntitiesNum += 1;
+            if (freeEntitiesNum > header->entitiesNum || getEntity(index)->archetypeHandle != ECS_WORLD_EMPTY_ARCHETYPE)
+            {
+                return false;
+            }
+        }
+        EcsComponentFlags sparseMask{ };
+        const EcsSnapshotSparseSet* sparseSets = reinterpret_cast<const EcsSnapshotSparseSet*>(file + header->sparseSetsOffset);
+        for (EcsSizeT it = 0; it < header->sparseSetsNum; it++)
+        {
+            if (!isMatchingComponent(sparseSets[it].typeHash, sparseSets[it].sizeBytes, EcsComponentStorage::SPARSE) ||
+                sparseMask.get_flag(ecs_find_component_id(sparseSets[it].typeHash)) || sparseSets[it].size > header->entitiesNum ||
+                !isInRange(sparseSets[it].handlesOffset, sizeof(EcsEntityHandle) * sparseSets[it].size, dataSize) ||
+                !isInRange(sparseSets[it].componentsOffset, sparseSets[it].sizeBytes * sparseSets[it].size, dataSize))
+            {
+                return false;
+            }
+            sparseMask.set_flag(ecs_find_component_id(sparseSets[it].typeHash));
+            const EcsEntityHandle* handles = reinterpret_cast<const EcsEntityHandle*>(file + header->dataOffset + sparseSets[it].handlesOffset);
+            for (EcsSizeT handleIt = 0; handleIt < sparseSets[it].size; handleIt++)
+            {
+                const uint32_t index = ecs_get_entity_handle_index(handles[handleIt]);
+                if (index >= header->entitiesNum || getEntity(index)->generation != ecs_get_entity_handle_generation(handles[handleIt]))
+                {
+                    return false;
+                }
+            }
+        }
+        EcsComponentFlags singletonsMask{ };
+        const EcsSnapshotSingleton* singletons = reinterpret_cast<const EcsSnapshotSingleton*>(file + header->singletonsOffset);
+        for (EcsSizeT it = 0; it < header->singletonsNum; it++)
+        {
+            const EcsComponentId componentId = ecs_find_component_id(singletons[it].typeHash);
+            if (componentId == ECS_WORLD_MAX_COMPONENTS || gEcsComponentInfos[componentId].sizeBytes != singletons[it].sizeBytes ||
+                singletonsMask.get_flag(componentId) || !isInRange(singletons[it].dataOffset, singletons[it].sizeBytes, dataSize))
+            {
+                return false;
+            }
+            singletonsMask.set_flag(componentId);
+        }
+        return true;
+    }
+
+    // @NOTE :  If chunk layout of the new archetype matches the stored one, stored chunks are used in place.
+    //          Otherwise new chunks are allocated and components are copied row by row.
+    EcsArchetypeHandle ecs_load_snapshot_archetype(EcsWorld* world, const EcsSnapshotArchetype* record)
+    {
+        constexpr EcsSizeT CHUNK_SIZE = EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE;
+        const EcsSnapshotHeader* header = reinterpret_cast<const EcsSnapshotHeader*>(world->snapshot.memory);
+        const EcsSnapshotComponent* components = reinterpret_cast<const EcsSnapshotComponent*>(world->snapshot.memory + header->componentsOffset) + record->firstComponent;
+        uint8_t* chunks = reinterpret_cast<uint8_t*>(world->snapshot.memory + header->chunksOffset) + CHUNK_SIZE * record->firstChunk;
+        EcsComponentFlags flags{ };
+        for (EcsSizeT it = 0; it < record->componentsNum; it++)
+        {
+            flags.set_flag(ecs_find_component_id(components[it].typeHash));
+        }
+        const EcsArchetypeHandle handle = ecs_create_archetype(world, flags);
+        EcsArchetype* archetype = ecs_get_archetype(world, handle);
+        bool isSameLayout = archetype->singleChunkCapacity == record->singleChunkCapacity;
+        for (EcsSizeT it = 0; it < record->componentsNum; it++)
+        {
+            const EcsSizeT componentIndex = ecs_get_component_index(archetype, ecs_find_component_id(components[it].typeHash));
+            switch (static_cast<EcsComponentStorage>(components[it].storage))
+            {
+                case EcsComponentStorage::CHUNK:
+                    isSameLayout = isSameLayout && archetype->componentArrayPointers[componentIndex] == components[it].offset;
+                    break;
+                case EcsComponentStorage::SHARED:
+                    std::memcpy(archetype->sharedComponents + archetype->componentArrayPointers[componentIndex], world->snapshot.memory + header->dataOffset + components[it].offset, components[it].sizeBytes);
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (isSameLayout)
+        {
+            for (EcsSizeT chunkIt = 0; chunkIt < record->chunksNum; chunkIt++)
+            {
+                push(&archetype->chunks, chunks + CHUNK_SIZE * chunkIt);
+                for (EcsSizeT it = 0; it < archetype->componentsNum; it++)
+                {
+                    push(&archetype->chunkVersions, world->changeVersion);
+                }
+            }
+            archetype->capacity = record->chunksNum * archetype->singleChunkCapacity;
+            archetype->size = record->size;
+            return handle;
+        }
+        ecs_reserve_positions(world, handle, record->size);
+        for (EcsSizeT row = 0; row < record->size; row++)
+        {
+            const uint8_t* chunk = chunks + CHUNK_SIZE * (row / record->singleChunkCapacity);
+            const EcsSizeT inChunkIndex = row % record->singleChunkCapacity;
+            *ecs_access_entity_handle(archetype, row) = reinterpret_cast<const EcsEntityHandle*>(chunk)[inChunkIndex];
+            for (EcsSizeT it = 0; it < record->componentsNum; it++)
+            {
+                if (static_cast<EcsComponentStorage>(components[it].storage) == EcsComponentStorage::CHUNK)
+                {
+                    uint8_t* component = ecs_access_component(world, handle, ecs_find_component_id(components[it].typeHash), row);
+                    std::memcpy(component, chunk + components[it].offset + components[it].sizeBytes * inChunkIndex, components[it].sizeBytes);
+                }
+            }
+        }
+        return handle;
+    }
+
+    EcsArchetypeHandle ecs_match_or_create_archetype(EcsWorld* world, EcsEntityHandle handle)
+    {
+        return ecs_find_or_create_archetype(world, ecs_get_archetype(world, ecs_get_entity(world, handle)->archetypeHandle)->componentFlags);
+    }
+
+    EcsArchetypeHandle ecs_find_or_create_archetype(EcsWorld* world, EcsComponentFlags flags)
+    {
+        EcsArchetypeHandle archetypeHandle = ecs_find_archetype(world, flags);
+        if (archetypeHandle != ECS_WORLD_INVALID_ARCHETYPE)
+        {
+            return archetypeHandle;
+        }
+        return ecs_create_archetype(world, flags);
+    }
+
+    EcsArchetypeHandle ecs_find_archetype(EcsWorld* world, EcsComponentFlags flags)
+    {
+        if (flags == EcsComponentFlags{ })
+        {
+            return ECS_WORLD_EMPTY_ARCHETYPE;
+        }
+        const EcsSizeT MASK = world->archetypeLookupSize - 1;
+        for (EcsSizeT position = ecs_hash_component_flags(flags) & MASK; ; position = (position + 1) & MASK)
+        {
+            const EcsArchetypeHandle archetypeHandle = world->archetypeLookup[position];
+            if (archetypeHandle == ECS_WORLD_EMPTY_ARCHETYPE)
+            {
+                return ECS_WORLD_INVALID_ARCHETYPE;
+            }
+            if (ecs_get_archetype(world, archetypeHandle)->componentFlags == flags)
+            {
+                return archetypeHandle;
+            }
+        }
+    }
+
+    void ecs_add_archetype_to_lookup(EcsWorld* world, EcsArchetypeHandle handle)
+    {
+        // @NOTE :  Lookup table stores all archetypes except the empty one
+        if ((world->archetypes.size - 1) * 2 > world->archetypeLookupSize)
+        {
+            ecs_grow_archetype_lookup(world);
+        }
+        // @NOTE :  Archetypes are never removed, so linear probing doesn't need tombstones
+        const EcsSizeT MASK = world->archetypeLookupSize - 1;
+        EcsSizeT position = ecs_hash_component_flags(ecs_get_archetype(world, handle)->componentFlags) & MASK;
+        while (world->archetypeLookup[position] != ECS_WORLD_EMPTY_ARCHETYPE)
+        {
+            position = (position + 1) & MASK;
+        }
+        world->archetypeLookup[position] = handle;
+    }
+
+    void ecs_grow_archetype_lookup(EcsWorld* world)
+    {
+        MemoryManager::get_pool()->deallocate(reinterpret_cast<std::byte*>(world->archetypeLookup), sizeof(EcsArchetypeHandle) * world->archetypeLookupSize);
+        world->archetypeLookupSize *= 2;
+        world->archetypeLookup = reinterpret_cast<EcsArchetypeHandle*>(MemoryManager::get_pool()->allocate(sizeof(EcsArchetypeHandle) * world->archetypeLookupSize));
+        al_assert_msg(world->archetypeLookup, "Can't grow archetype lookup table : pool allocator is out of memory.")
+        for (EcsSizeT it = 0; it < world->archetypeLookupSize; it++)
+        {
+            world->archetypeLookup[it] = ECS_WORLD_EMPTY_ARCHETYPE;
+        }
+        // @NOTE :  Last archetype is added by the caller
+        const EcsSizeT MASK = world->archetypeLookupSize - 1;
+        for (EcsSizeT handle = 1; handle < world->archetypes.size - 1; handle++)
+        {
+            EcsSizeT position = ecs_hash_component_flags(ecs_get_archetype(world, handle)->componentFlags) & MASK;
+            while (world->archetypeLookup[position] != ECS_WORLD_EMPTY_ARCHETYPE)
+            {
+                position = (position + 1) & MASK;
+            }
+            world->archetypeLookup[position] = handle;
+        }
+    }
+
+    // @NOTE :  Chunk starts with entity handles array, component arrays follow it.
+    //          Tags and shared components don't have arrays in chunks. Offset of tag is zero,
+    //          so pointer to tag is a valid (but never dereferenced) pointer to the chunk.
+    //          componentArrayOffsets is indexed by component index (see ecs_get_component_index).
+    EcsSizeT ecs_compute_chunk_layout(EcsComponentFlags flags, EcsSizeT capacity, EcsSizeT* componentArrayOffsets)
+    {
+        EcsSizeT currentOffset = sizeof(EcsEntityHandle) * capacity;
+        EcsSizeT componentIndex = 0;
+        for_each_set_flag(flags, it)
+        {
+            const EcsSizeT index = componentIndex++;
+            if (gEcsComponentInfos[it].storage != EcsComponentStorage::CHUNK)
+            {
+                if (componentArrayOffsets && gEcsComponentInfos[it].storage == EcsComponentStorage::TAG)
+                {
+                    componentArrayOffsets[index] = 0;
+                }
+                continue;
+            }
+            currentOffset = align_up(currentOffset, gEcsComponentInfos[it].alignment);
+            if (componentArrayOffsets)
+            {
+                componentArrayOffsets[index] = currentOffset;
+            }
+            currentOffset += gEcsComponentInfos[it].sizeBytes * capacity;
+        }
+        return currentOffset;
+    }
+
+    void ecs_clear_archetype_edges(EcsWorld* world, EcsArchetypeHandle handle)
+    {
+        EcsArchetype* archetype = ecs_get_archetype(world, handle);
+        archetype->addEdges.size = 0;
+        for (EcsSizeT it = 0; it < archetype->componentsNum; it++)
+        {
+            archetype->removeEdges[it] = ECS_WORLD_INVALID_ARCHETYPE;
+        }
+    }
+
+    // @NOTE :  Edges are resolved lazily. When edge is resolved, opposite edge of the
+    //          destination archetype is set too, so the way back is already cached.
+    //          Adding or removing several components at once follows one edge per component,
+    //          so intermediate archetypes are created (without chunks) on the first transition.
+    EcsArchetypeHandle ecs_get_add_edge(EcsWorld* world, EcsArchetypeHandle handle, EcsComponentId componentId)
+    {
+        EcsArchetype* archetype = ecs_get_archetype(world, handle);
+        if (archetype->componentFlags.get_flag(componentId))
+        {
+            return handle;
+        }
+        for_each_dynamic_array(archetype->addEdges, it)
+        {
+            const EcsArchetypeEdge* edge = get(&archetype->addEdges, it);
+            if (edge->componentId == componentId)
+            {
+                return edge->archetypeHandle;
+            }
+        }
+        EcsComponentFlags flags = archetype->componentFlags;
+        flags.set_flag(componentId);
+        EcsArchetypeHandle destination = ecs_find_archetype(world, flags);
+        if (destination == ECS_WORLD_INVALID_ARCHETYPE)
+        {
+            destination = ecs_create_archetype(world, flags);
+            ecs_copy_shared_components(world, handle, destination);
+        }
+        push(&archetype->addEdges, EcsArchetypeEdge{ componentId, destination });
+        EcsArchetype* destinationArchetype = ecs_get_archetype(world, destination);
+        destinationArchetype->removeEdges[ecs_get_component_index(destinationArchetype, componentId)] = handle;
+        return destination;
+    }
+
+    EcsArchetypeHandle ecs_get_remove_edge(EcsWorld* world, EcsArchetypeHandle handle, EcsComponentId componentId)
+    {
+        EcsArchetype* archetype = ecs_get_archetype(world, handle);
+        if (!archetype->componentFlags.get_flag(componentId))
+        {
+            return handle;
+        }
+        EcsArchetypeHandle* edge = &archetype->removeEdges[ecs_get_component_index(archetype, componentId)];
+        if (*edge == ECS_WORLD_INVALID_ARCHETYPE)
+        {
+            EcsComponentFlags flags = archetype->componentFlags;
+            flags.clear_flag(componentId);
+            EcsArchetypeHandle destination = ecs_find_archetype(world, flags);
+            if (destination == ECS_WORLD_INVALID_ARCHETYPE)
+            {
+                destination = ecs_create_archetype(world, flags);
+                ecs_copy_shared_components(world, handle, destination);
+            }
+            *edge = destination;
+            EcsArchetype* destinationArchetype = ecs_get_archetype(world, destination);
+            bool hasAddEdge = false;
+            for_each_dynamic_array(destinationArchetype->addEdges, it)
+            {
+                hasAddEdge = hasAddEdge || get(&destinationArchetype->addEdges, it)->componentId == componentId;
+            }
+            if (!hasAddEdge)
+            {
+                push(&destinationArchetype->addEdges, EcsArchetypeEdge{ componentId, handle });
+            }
+        }
+        return *edge;
+    }
+
+    EcsSizeT ecs_hash_component_flags(EcsComponentFlags flags)
+    {
+        // @NOTE :  Masks of neighbour archetypes differ in a single bit and most words of the mask are zero,
+        //          while lookup uses only the low bits of the hash (power of two table). Flags are mixed
+        //          (splitmix64 finalizer), so every bit of every word affects the table position
+        auto mix = [](uint64_t value) -> uint64_t
+        {
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+            return value ^ (value >> 31);
+        };
+        uint64_t hash = 0;
+        for (EcsSizeT it = 0; it < EcsComponentFlags::WORDS_NUM; it++)
+        {
+            hash = mix(flags.flags[it] ^ mix(hash + 0x9e3779b97f4a7c15ULL));
+        }
+        return hash;
+    }
+
+    EcsArchetypeHandle ecs_create_archetype(EcsWorld* world, EcsComponentFlags flags)
+    {
+        const EcsSizeT componentsNum = flags.count();
+        std::byte* memory = MemoryManager::get_pool()->allocate(ecs_get_archetype_allocation_size(componentsNum));
+        al_assert_msg(memory, "Can't create new archetype : pool allocator is out of memory.");
+        EcsArchetype* archetype = reinterpret_cast<EcsArchetype*>(memory);
+        archetype->componentArrayPointers = reinterpret_cast<EcsSizeT*>(memory + sizeof(EcsArchetype));
+        archetype->removeEdges = reinterpret_cast<EcsArchetypeHandle*>(archetype->componentArrayPointers + componentsNum);
+        construct(&archetype->addEdges);
+        construct(&archetype->chunks);
+        construct(&archetype->chunkVersions);
+        archetype->componentFlags       = flags;
+        archetype->chunkComponentFlags  = { };
+        archetype->sharedComponents     = nullptr;
+        archetype->sharedComponentsSize = 0;
+        archetype->size                 = 0;
+        archetype->capacity             = 0;
+        archetype->singleChunkCapacity  = 0;
+        archetype->selfHandle           = world->archetypes.size;
+        archetype->componentsNum        = componentsNum;
+        push(&world->archetypes, archetype);
+        push(&world->archetypeMasks, flags);
+        ecs_clear_archetype_edges(world, archetype->selfHandle);
+        if (archetype->selfHandle == ECS_WORLD_EMPTY_ARCHETYPE)
+        {
+            // @NOTE :  Empty archetype doesn't store entities
+            return archetype->selfHandle;
+        }
+        EcsSizeT singleEntrySize = sizeof(EcsEntityHandle);
+        for_each_set_flag(archetype->componentFlags, it)
+        {
+            if (gEcsComponentInfos[it].storage != EcsComponentStorage::CHUNK)
+            {
+                continue;
+            }
+            archetype->chunkComponentFlags.set_flag(it);
+            singleEntrySize += gEcsComponentInfos[it].sizeBytes;
+        }
+        // @NOTE :  Each component array starts at aligned offset, so capacity is reduced
+        //          until arrays with alignment padding fit into the chunk
+        EcsSizeT capacity = EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE / singleEntrySize;
+        while (ecs_compute_chunk_layout(flags, capacity, nullptr) > EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE)
+        {
+            capacity -= 1;
+        }
+        al_assert_msg(capacity, "Archetype components don't fit into single chunk. Consider increasing EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE value.");
+        archetype->singleChunkCapacity = capacity;
+        ecs_compute_chunk_layout(flags, capacity, archetype->componentArrayPointers);
+        ecs_allocate_shared_components(archetype);
+        ecs_add_archetype_to_lookup(world, archetype->selfHandle);
+        for_each_array_container(world->queries, it)
+        {
+            ecs_query_try_add_archetype(world, *get(&world->queries, it), archetype->selfHandle);
+        }
+        return archetype->selfHandle;
+    }
+
+    void ecs_allocate_shared_components(EcsArchetype* archetype)
+    {
+        EcsSizeT currentOffset = 0;
+        EcsSizeT componentIndex = 0;
+        for_each_set_flag(archetype->componentFlags, it)
+        {
+            const EcsSizeT index = componentIndex++;
+            if (gEcsComponentInfos[it].storage != EcsComponentStorage::SHARED)
+            {
+                continue;
+            }
+            currentOffset = align_up(currentOffset, gEcsComponentInfos[it].alignment);
+            archetype->componentArrayPointers[index] = currentOffset;
+            currentOffset += gEcsComponentInfos[it].sizeBytes;
+        }
+        if (currentOffset == 0)
+        {
+            return;
+        }
+        archetype->sharedComponents = reinterpret_cast<uint8_t*>(MemoryManager::get_pool()->allocate(currentOffset));
+        al_assert_msg(archetype->sharedComponents, "Can't create new archetype : pool allocator is out of memory.");
+        archetype->sharedComponentsSize = currentOffset;
+        std::memset(archetype->sharedComponents, 0, currentOffset);
+    }
+
+    void ecs_copy_shared_components(EcsWorld* world, EcsArchetypeHandle from, EcsArchetypeHandle to)
+    {
+        EcsArchetype* fromArchetype = ecs_get_archetype(world, from);
+        EcsArchetype* toArchetype = ecs_get_archetype(world, to);
+        if (!fromArchetype->sharedComponents || !toArchetype->sharedComponents)
+        {
+            return;
+        }
+        const EcsComponentFlags commonFlags = fromArchetype->componentFlags & toArchetype->componentFlags;
+        for_each_set_flag(commonFlags, it)
+        {
+            if (gEcsComponentInfos[it].storage != EcsComponentStorage::SHARED)
+            {
+                continue;
+            }
+            std::memcpy(toArchetype->sharedComponents + toArchetype->componentArrayPointers[ecs_get_component_index(toArchetype, it)], fromArchetype->sharedComponents + fromArchetype->componentArrayPointers[ecs_get_component_index(fromArchetype, it)], gEcsComponentInfos[it].sizeBytes);
+        }
+    }
+
+    void ecs_allocate_chunks(EcsWorld* world, EcsArchetypeHandle handle)
+    {
+        EcsArchetype* archetype = ecs_get_archetype(world, handle);
+        push(&archetype->chunks, reinterpret_cast<uint8_t*>(MemoryManager::get_ecs_pool()->allocate(EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE)));
+        for (EcsSizeT it = 0; it < archetype->componentsNum; it++)
+        {
+            push(&archetype->chunkVersions, world->changeVersion);
+        }
+        archetype->capacity += archetype->singleChunkCapacity;
+    }
+
+    void ecs_move_entity_superset(EcsWorld* world, EcsArchetypeHandle from, EcsArchetypeHandle to, EcsEntityHandle handle)
+    {
+        EcsArchetype*   fromArchetype   = ecs_get_archetype(world, from);
+        EcsArchetype*   toArchetype     = ecs_get_archetype(world, to);
+        EcsEntity*      entityPtr       = ecs_get_writable_entity(world, handle);
+        EcsSizeT        fromIndex       = entityPtr->archetypeArrayIndex;
+        EcsSizeT        toIndex         = ecs_reserve_position(world, to);
+        for_each_set_flag(fromArchetype->chunkComponentFlags, it)
+        {
+            uint8_t* fromComponent = ecs_access_component(world, from, it, fromIndex);
+            uint8_t* toComponent = ecs_access_component(world, to, it, toIndex);
+            std::memcpy(toComponent, fromComponent, gEcsComponentInfos[it].sizeBytes);
+        }
+        *ecs_access_entity_handle(toArchetype, toIndex) = handle;
+        ecs_free_position(world, from, fromIndex);
+        entityPtr->archetypeHandle = to;
+        entityPtr->archetypeArrayIndex = toIndex;
+        ecs_record_observer_events(world, EcsObserverEvent::ADD, toArchetype->componentFlags & ~fromArchetype->componentFlags, { &handle, 1 });
+    }
+
+    void ecs_move_entity_subset(EcsWorld* world, EcsArchetypeHandle from, EcsArchetypeHandle to, EcsEntityHandle handle)
+    {
+        EcsArchetype*   fromArchetype   = ecs_get_archetype(world, from);
+        EcsArchetype*   toArchetype     = ecs_get_archetype(world, to);
+        EcsEntity*      entityPtr       = ecs_get_writable_entity(world, handle);
+        EcsSizeT        fromIndex       = entityPtr->archetypeArrayIndex;
+        EcsSizeT        toIndex         = ecs_reserve_position(world, to);
+        for_each_set_flag(toArchetype->chunkComponentFlags, it)
+        {
+            uint8_t* fromComponent = ecs_access_component(world, from, it, fromIndex);
+            uint8_t* toComponent = ecs_access_component(world, to, it, toIndex);
+            std::memcpy(toComponent, fromComponent, gEcsComponentInfos[it].sizeBytes);
+        }
+        if (to != ECS_WORLD_EMPTY_ARCHETYPE)
+        {
+            *ecs_access_entity_handle(toArchetype, toIndex) = handle;
+        }
+        ecs_free_position(world, from, fromIndex);
+        entityPtr->archetypeHandle = to;
+        entityPtr->archetypeArrayIndex = toIndex;
+        ecs_record_observer_events(world, EcsObserverEvent::REMOVE, fromArchetype->componentFlags & ~toArchetype->componentFlags, { &handle, 1 });
+    }
+
+    // @NOTE :  Moves entities which are stored in the same archetype. Destination rows are reserved at once.
+    //          Components of entities which are stored in consecutive rows of the same chunk are copied
+    //          with a single memcpy per column (this is the usual case for entities created together).
+    void ecs_move_entities(EcsWorld* world, EcsArchetypeHandle from, EcsArchetypeHandle to, std::span<const EcsEntityHandle> handles)
+    {
+        EcsArchetype*           fromArchetype   = ecs_get_archetype(world, from);
+        EcsArchetype*           toArchetype     = ecs_get_archetype(world, to);
+        const EcsSizeT          count           = handles.size();
+        const EcsSizeT          firstToIndex    = ecs_reserve_positions(world, to, count);
+        const EcsComponentFlags toFlags         = toArchetype->chunkComponentFlags;
+        const EcsComponentFlags commonFlags     = fromArchetype->chunkComponentFlags & toFlags;
+        const EcsComponentFlags newFlags        = toFlags & ~commonFlags;
+        if (to != ECS_WORLD_EMPTY_ARCHETYPE)
+        {
+            for (EcsSizeT it = 0; it < count; )
+            {
+                const EcsSizeT fromIndex = ecs_get_entity(world, handles[it])->archetypeArrayIndex;
+                const EcsSizeT toIndex = firstToIndex + it;
+                EcsSizeT rowsNum = 1;
+                if (from != ECS_WORLD_EMPTY_ARCHETYPE)
+                {
+                    while ((it + rowsNum) < count &&
+                           ecs_get_entity(world, handles[it + rowsNum])->archetypeArrayIndex == fromIndex + rowsNum &&
+                           (fromIndex + rowsNum) % fromArchetype->singleChunkCapacity != 0 &&
+                           (toIndex + rowsNum) % toArchetype->singleChunkCapacity != 0)
+                    {
+                        rowsNum++;
+                    }
+                    for_each_set_flag(commonFlags, componentIt)
+                    {
+                        uint8_t* fromComponent = ecs_access_component(world, from, componentIt, fromIndex);
+                        uint8_t* toComponent = ecs_access_component(world, to, componentIt, toIndex);
+                        std::memcpy(toComponent, fromComponent, gEcsComponentInfos[componentIt].sizeBytes * rowsNum);
+                    }
+                }
+                for (EcsSizeT rowIt = 0; rowIt < rowsNum; rowIt++)
+                {
+                    *ecs_access_entity_handle(toArchetype, toIndex + rowIt) = handles[it + rowIt];
+                }
+                it += rowsNum;
+            }
+            ecs_zero_components(world, to, newFlags, firstToIndex, count);
+        }
+        // @NOTE :  Entities are removed in reverse order, so entities which were created together
+        //          are usually removed from the end of the archetype and no rows are moved
+        for (EcsSizeT it = count; it > 0; it--)
+        {
+            ecs_free_position(world, from, ecs_get_entity(world, handles[it - 1])->archetypeArrayIndex);
+        }
+        for (EcsSizeT it = 0; it < count; it++)
+        {
+            EcsEntity* entity = ecs_get_writable_entity(world, handles[it]);
+            entity->archetypeHandle = to;
+            entity->archetypeArrayIndex = to == ECS_WORLD_EMPTY_ARCHETYPE ? 0 : firstToIndex + it;
+        }
+        ecs_record_observer_events(world, EcsObserverEvent::ADD, toArchetype->componentFlags & ~fromArchetype->componentFlags, handles);
+        ecs_record_observer_events(world, EcsObserverEvent::REMOVE, fromArchetype->componentFlags & ~toArchetype->componentFlags, handles);
+    }
+
+    EcsSizeT ecs_reserve_position(EcsWorld* world, EcsArchetypeHandle handle)
+    {
+        if (handle == ECS_WORLD_EMPTY_ARCHETYPE)
+        {
+            return 0;
+        }
+        EcsArchetype* archetype = ecs_get_archetype(world, handle);
+        EcsSizeT position = archetype->size;
+        archetype->size += 1;
+        if (archetype->size >= archetype->capacity)
+        {
+            ecs_allocate_chunks(world, handle);
+        }
+        ecs_mark_chunk_changed(world, archetype, position / archetype->singleChunkCapacity);
+        return position;
+    }
+
+    EcsSizeT ecs_reserve_positions(EcsWorld* world, EcsArchetypeHandle handle, EcsSizeT count)
+    {
+        if (handle == ECS_WORLD_EMPTY_ARCHETYPE)
+        {
+            return 0;
+        }
+        EcsArchetype* archetype = ecs_get_archetype(world, handle);
+        EcsSizeT position = archetype->size;
+        archetype->size += count;
+        while (archetype->size >= archetype->capacity)
+        {
+            ecs_allocate_chunks(world, handle);
+        }
+        ecs_mark_chunks_changed(world, archetype, position, count);
+        return position;
+    }
+
+    void ecs_zero_components(EcsWorld* world, EcsArchetypeHandle handle, EcsComponentFlags flags, EcsSizeT index, EcsSizeT count)
+    {
+        if (handle == ECS_WORLD_EMPTY_ARCHETYPE)
+        {
+            return;
+        }
+        EcsArchetype* archetype = ecs_get_archetype(world, handle);
+        while (count)
+        {
+            const EcsSizeT rowsNum = minimum(count, archetype->singleChunkCapacity - index % archetype->singleChunkCapacity);
+            ecs_get_writable_chunk(world, archetype, index / archetype->singleChunkCapacity);
+            for_each_set_flag(flags, it)
+            {
+                std::memset(ecs_access_component(world, handle, it, index), 0, gEcsComponentInfos[it].sizeBytes * rowsNum);
+            }
+            index += rowsNum;
+            count -= rowsNum;
+        }
+    }
+
+    void ecs_free_position(EcsWorld* world, EcsArchetypeHandle handle, EcsSizeT index)
+    {
+        if (handle == ECS_WORLD_EMPTY_ARCHETYPE)
+        {
+            return;
+        }
+        EcsArchetype* archetype = ecs_get_archetype(world, handle);
+        al_assert(archetype->size != 0);
+        EcsSizeT lastIndex = archetype->size - 1;
+        if (index != lastIndex)
+        {
+            ecs_mark_chunk_changed(world, archetype, index / archetype->singleChunkCapacity);
+            ecs_copy_components(world, handle, lastIndex, index);
+            const EcsEntityHandle lastHandle = *ecs_access_entity_handle(archetype, lastIndex);
+            *ecs_access_entity_handle(archetype, index) = lastHandle;
+            ecs_get_writable_entity(world, lastHandle)->archetypeArrayIndex = index;
+        }
+        ecs_zero_components(world, handle, archetype->chunkComponentFlags, lastIndex, 1);
+        archetype->size -= 1;
+    }
+
+    // @NOTE :  Removes several rows at once. Holes below the new archetype size are filled
+    //          with the remaining rows from the end of the archetype, so each surviving row is
+    //          moved at most once, and the freed tail is cleared with a memset per column and chunk.
+    //          Indices are sorted in place and must be unique.
+    void ecs_free_positions(EcsWorld* world, EcsArchetypeHandle handle, std::span<EcsSizeT> indices)
+    {
+        if (handle == ECS_WORLD_EMPTY_ARCHETYPE || indices.empty())
+        {
+            return;
+        }
+        EcsArchetype* archetype = ecs_get_archetype(world, handle);
+        al_assert(indices.size() <= archetype->size);
+        std::sort(indices.begin(), indices.end());
+        const EcsSizeT newSize = archetype->size - indices.size();
+        EcsSizeT holeIt = 0;
+        EcsSizeT tailRemovedIt = indices.size();
+        EcsSizeT source = archetype->size;
+        while (holeIt < indices.size() && indices[holeIt] < newSize)
+        {
+            // @NOTE :  Find last row which is not removed
+            source -= 1;
+            while (tailRemovedIt > 0 && indices[tailRemovedIt - 1] == source)
+            {
+                tailRemovedIt -= 1;
+                source -= 1;
+            }
+            const EcsSizeT hole = indices[holeIt++];
+            ecs_mark_chunk_changed(world, archetype, hole / archetype->singleChunkCapacity);
+            ecs_copy_components(world, handle, source, hole);
+            const EcsEntityHandle sourceHandle = *ecs_access_entity_handle(archetype, source);
+            *ecs_access_entity_handle(archetype, hole) = sourceHandle;
+            ecs_get_writable_entity(world, sourceHandle)->archetypeArrayIndex = hole;
+        }
+        ecs_zero_components(world, handle, archetype->chunkComponentFlags, newSize, indices.size());
+        archetype->size = newSize;
+    }
+
+    void ecs_copy_components(EcsWorld* world, EcsArchetypeHandle handle, EcsSizeT from, EcsSizeT to)
+    {
+        EcsArchetype* archetype = ecs_get_archetype(world, handle);
+        for_each_set_flag(archetype->chunkComponentFlags, it)
+        {
+            std::memcpy(ecs_access_component(world, handle, it, to), ecs_access_component(world, handle, it, from), gEcsComponentInfos[it].sizeBytes);
+        }
+    }
+
+    uint8_t* ecs_access_component(EcsWorld* world, EcsArchetypeHandle handle, EcsComponentId componentId, EcsSizeT index)
+    {
+        EcsArchetype* archetype = ecs_get_archetype(world, handle);
+        if (!archetype->componentFlags.get_flag(componentId))
+        {
+            return nullptr;
+        }
+        if (archetype->size <= index)
+        {
+            return nullptr;
+        }
+        if (gEcsComponentInfos[componentId].storage == EcsComponentStorage::SHARED)
+        {
+            return archetype->sharedComponents + archetype->componentArrayPointers[ecs_get_component_index(archetype, componentId)];
+        }
+        EcsSizeT chunkIndex = index / archetype->singleChunkCapacity;
+        EcsSizeT inChunkIndex = index % archetype->singleChunkCapacity;
+        return *get(&archetype->chunks, chunkIndex) + archetype->componentArrayPointers[ecs_get_component_index(archetype, componentId)] + inChunkIndex * gEcsComponentInfos[componentId].sizeBytes;
+    }
+
+    template<typename T>
+    T* ecs_access_component(EcsArchetype* archetype, EcsSizeT index)
+    {
+        EcsSizeT chunkIndex = index / archetype->singleChunkCapacity;
+        EcsSizeT inChunkIndex = index % archetype->singleChunkCapacity;
+        return ecs_access_row(ecs_access_chunk_component_array<T>(archetype, chunkIndex), inChunkIndex);
+    };
+
+    template<typename T>
+    T* ecs_access_chunk_component_array(EcsArchetype* archetype, EcsSizeT chunkIndex)
+    {
+        EcsComponentId componentId = ecs_component_type_info_get_id<T>();
+        return ecs_access_column<T>(archetype, *get(&archetype->chunks, chunkIndex), archetype->componentArrayPointers[ecs_get_component_index(archetype, componentId)]);
+    }
+
+    template<typename T>
+    T* ecs_access_column(EcsArchetype* archetype, uint8_t* chunk, EcsSizeT columnOffset)
+    {
+        if constexpr (ecs_component_type_info_get_storage<std::remove_const_t<T>>() == EcsComponentStorage::SHARED)
+        {
+            return reinterpret_cast<T*>(archetype->sharedComponents + columnOffset);
+        }
+        else
+        {
+            return reinterpret_cast<T*>(chunk + columnOffset);
+        }
+    }
+
+    template<typename T>
+    T* ecs_access_row(T* column, EcsSizeT index)
+    {
+        if constexpr (ecs_component_type_info_get_storage<std::remove_const_t<T>>() == EcsComponentStorage::SHARED)
+        {
+            return column;
+        }
+        else
+        {
+            return column + index;
+        }
+    }
+
+    template<typename T>
+    std::span<T> ecs_make_column_span(T* column, EcsSizeT entitiesNum)
+    {
+        if constexpr (ecs_component_type_info_get_storage<std::remove_const_t<T>>() == EcsComponentStorage::SHARED)
+        {
+            return std::span<T>{ column, 1 };
+        }
+        else
+        {
+            return std::span<T>{ column, entitiesNum };
+        }
+    }
+
+    template<typename ... T, typename Func>
+    void ecs_for_each_in_chunk(EcsWorld* world, EcsArchetype* archetype, EcsSizeT chunkIndex, Func* func)
+    {
+        static_assert(!ecs_has_sparse_components<T...>(), "Sparse components are not stored in chunks");
+        const EcsSizeT entitiesNum = ecs_get_chunk_entities_num(archetype, chunkIndex);
+        (ecs_mark_component_changed<T>(world, archetype, chunkIndex), ...);
+        const EcsEntityHandle* entityHandles = ecs_access_chunk_entity_handles(archetype, chunkIndex);
+        auto process = [&](T* ... componentArrays)
+        {
+            for (EcsSizeT it = 0; it < entitiesNum; it++)
+            {
+                (*func)(world, entityHandles[it], ecs_access_row(componentArrays, it)...);
+            }
+        };
+        process(ecs_access_chunk_component_array<T>(archetype, chunkIndex)...);
+    }
+
+    EcsEntityHandle* ecs_access_entity_handle(EcsArchetype* archetype, EcsSizeT index)
+    {
+        return ecs_access_chunk_entity_handles(archetype, index / archetype->singleChunkCapacity) + index % archetype->singleChunkCapacity;
+    }
+
+    EcsEntityHandle* ecs_access_chunk_entity_handles(EcsArchetype* archetype, EcsSizeT chunkIndex)
+    {
+        return reinterpret_cast<EcsEntityHandle*>(*get(&archetype->chunks, chunkIndex));
+    }
+
+    EcsSizeT ecs_get_chunk_entities_num(EcsArchetype* archetype, EcsSizeT chunkIndex)
+    {
+        const EcsSizeT firstIndex = chunkIndex * archetype->singleChunkCapacity;
+        return minimum(archetype->size - firstIndex, archetype->singleChunkCapacity);
+    }
+
+    EcsSizeT* ecs_get_chunk_versions(EcsArchetype* archetype, EcsSizeT chunkIndex)
+    {
+        return get(&archetype->chunkVersions, chunkIndex * archetype->componentsNum);
+    }
+
+    // @NOTE :  Column offsets, remove edges and chunk versions are stored in component id order,
+    //          so index of component is a number of archetype components with lower ids
+    EcsSizeT ecs_get_component_index(EcsArchetype* archetype, EcsComponentId componentId)
+    {
+        return archetype->componentFlags.count_below(componentId);
+    }
+
+    // @NOTE :  Chunk is marked before it is written, so marking also replaces shared chunk with it's copy
+    void ecs_mark_chunk_changed(EcsWorld* world, EcsArchetype* archetype, EcsSizeT chunkIndex)
+    {
+        ecs_get_writable_chunk(world, archetype, chunkIndex);
+        EcsSizeT* versions = ecs_get_chunk_versions(archetype, chunkIndex);
+        for (EcsSizeT it = 0; it < archetype->componentsNum; it++)
+        {
+            versions[it] = world->changeVersion;
+        }
+    }
+
+    void ecs_mark_chunks_changed(EcsWorld* world, EcsArchetype* archetype, EcsSizeT index, EcsSizeT count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        const EcsSizeT lastChunk = (index + count - 1) / archetype->singleChunkCapacity;
+        for (EcsSizeT chunkIt = index / archetype->singleChunkCapacity; chunkIt <= lastChunk; chunkIt++)
+        {
+            ecs_mark_chunk_changed(world, archetype, chunkIt);
+        }
+    }
+
+    void ecs_mark_component_changed(EcsWorld* world, EcsArchetype* archetype, EcsSizeT chunkIndex, EcsComponentId componentId)
+    {
+        if (gEcsComponentInfos[componentId].storage == EcsComponentStorage::CHUNK)
+        {
+            ecs_get_writable_chunk(world, archetype, chunkIndex);
+        }
+        ecs_get_chunk_versions(archetype, chunkIndex)[ecs_get_component_index(archetype, componentId)] = world->changeVersion;
+    }
+
+    template<typename T>
+    void ecs_mark_component_changed(EcsWorld* world, EcsArchetype* archetype, EcsSizeT chunkIndex)
+    {
+        if constexpr (!std::is_const_v<T> && ecs_component_type_info_get_storage<T>() != EcsComponentStorage::SPARSE)
+        {
+            ecs_mark_component_changed(world, archetype, chunkIndex, ecs_component_type_info_get_id<T>());
+        }
+    }
+
+    template<typename ... T, std::size_t ... Indices>
+    void ecs_mark_components_changed(EcsWorld* world, EcsSizeT* chunkVersions, const EcsSizeT* versionIndices, std::index_sequence<Indices...>)
+    {
+        ((std::is_const_v<EcsQueryTermType<T>> || versionIndices[Indices] == ECS_QUERY_ABSENT_COLUMN ? void() : void(chunkVersions[versionIndices[Indices]] = world->changeVersion)), ...);
+    }
+
+    bool ecs_is_chunk_changed(const EcsQueryState* state, const EcsSizeT* chunkVersions, const EcsSizeT* versionIndices)
+    {
+        if (!state || !state->changedFilterMask)
+        {
+            return true;
+        }
+        for (EcsSizeT it = 0; it < state->componentsNum; it++)
+        {
+            if ((state->changedFilterMask & (EcsSizeT{ 1 } << it)) && versionIndices[it] != ECS_QUERY_ABSENT_COLUMN && chunkVersions[versionIndices[it]] > state->lastRunVersion)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ecs_finish_query_iteration(EcsWorld* world, EcsQueryState* state)
+    {
+        state->lastRunVersion = world->changeVersion;
+        world->changeVersion += 1;
+    }
+
+    EcsSparseSet* ecs_get_sparse_set(EcsWorld* world, EcsComponentId componentId)
+    {
+        return world->sparseSets[componentId];
+    }
+
+    EcsSparseSet* ecs_get_or_create_sparse_set(EcsWorld* world, EcsComponentId componentId)
+    {
+        EcsSparseSet* set = world->sparseSets[componentId];
+        if (set)
+        {
+            return set;
+        }
+        set = reinterpret_cast<EcsSparseSet*>(MemoryManager::get_pool()->allocate(sizeof(EcsSparseSet)));
+        al_assert_msg(set, "Can't create sparse set : pool allocator is out of memory.")
+        construct(&set->pages);
+        construct(&set->handles);
+        construct(&set->components);
+        set->sizeBytes = gEcsComponentInfos[componentId].sizeBytes;
+        world->sparseSets[componentId] = set;
+        push(&world->sparseComponentIds, componentId);
+        return set;
+    }
+
+    // @NOTE :  Copies dense arrays of the empty sparse set at once. Positions are not changed, caller fills position pages.
+    void ecs_fill_sparse_set(EcsSparseSet* set, const EcsEntityHandle* handles, const uint8_t* components, EcsSizeT size)
+    {
+        al_assert_msg(set->handles.size == 0, "Can't fill sparse set : set is not empty")
+        if (!size)
+        {
+            return;
+        }
+        expand(&set->handles, size);
+        std::memcpy(set->handles.memory, handles, sizeof(EcsEntityHandle) * size);
+        set->handles.size = size;
+        if (set->sizeBytes)
+        {
+            expand(&set->components, set->sizeBytes * size);
+            std::memcpy(set->components.memory, components, set->sizeBytes * size);
+            set->components.size = set->sizeBytes * size;
+        }
+    }
+
+    // @NOTE :  Position pages can be shared with snapshots (see ecs_create_snapshot), so position which is going
+    //          to be written is accessed with isWrite : missing page is allocated and shared page is copied.
+    uint32_t* ecs_access_sparse_position(EcsWorld* world, EcsSparseSet* set, uint32_t entityIndex, bool isWrite)
+    {
+        const EcsSizeT pageIndex = entityIndex / ECS_SPARSE_SET_POSITIONS_IN_PAGE;
+        if (pageIndex >= set->pages.size || !*get(&set->pages, pageIndex))
+        {
+            if (!isWrite)
+            {
+                return nullptr;
+            }
+            while (pageIndex >= set->pages.size)
+            {
+                push(&set->pages, static_cast<uint32_t*>(nullptr));
+            }
+            uint32_t* page = reinterpret_cast<uint32_t*>(MemoryManager::get_ecs_pool()->allocate(EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE));
+            al_assert_msg(page, "Can't allocate sparse set page : ecs pool is out of memory. Consider increasing EngineConfig::ECS_POOL_ALLOCATOR_MEMORY_SIZE value.")
+            for (EcsSizeT it = 0; it < ECS_SPARSE_SET_POSITIONS_IN_PAGE; it++)
+            {
+                page[it] = ECS_WORLD_INVALID_ENTITY_INDEX;
+            }
+            *get(&set->pages, pageIndex) = page;
+        }
+        else if (isWrite)
+        {
+            uint32_t** page = get(&set->pages, pageIndex);
+            *page = reinterpret_cast<uint32_t*>(ecs_get_writable_block(world, reinterpret_cast<std::byte*>(*page)));
+        }
+        return *get(&set->pages, pageIndex) + entityIndex % ECS_SPARSE_SET_POSITIONS_IN_PAGE;
+    }
+
+    // @NOTE :  Pointer to sparse tag is a valid (but never dereferenced) pointer to the dense handle
+    uint8_t* ecs_sparse_get(EcsWorld* world, EcsComponentId componentId, EcsEntityHandle handle)
+    {
+        EcsSparseSet* set = ecs_get_sparse_set(world, componentId);
+        if (!set)
+        {
+            return nullptr;
+        }
+        const uint32_t* position = ecs_access_sparse_position(world, set, ecs_get_entity_handle_index(handle), false);
+        if (!position || *position == ECS_WORLD_INVALID_ENTITY_INDEX || *get(&set->handles, *position) != handle)
+        {
+            return nullptr;
+        }
+        return set->sizeBytes ? get(&set->components, *position * set->sizeBytes) : reinterpret_cast<uint8_t*>(get(&set->handles, *position));
+    }
+
+    // @NOTE :  New component is zeroed. If entity already has the component, it is not changed.
+    uint8_t* ecs_sparse_insert(EcsWorld* world, EcsComponentId componentId, EcsEntityHandle handle)
+    {
+        al_assert_msg(ecs_is_entity_alive(world, handle), "Can't add sparse component %" PRIu64 " : entity is not alive", componentId)
+        if (uint8_t* component = ecs_sparse_get(world, componentId, handle))
+        {
+            return component;
+        }
+        EcsSparseSet* set = ecs_get_or_create_sparse_set(world, componentId);
+        *ecs_access_sparse_position(world, set, ecs_get_entity_handle_index(handle), true) = static_cast<uint32_t>(set->handles.size);
+        push(&set->handles, handle);
+        ecs_record_observer_event(world, EcsObserverEvent::ADD, componentId, handle);
+        if (!set->sizeBytes)
+        {
+            return reinterpret_cast<uint8_t*>(get(&set->handles, set->handles.size - 1));
+        }
+        DynamicArray<uint8_t>* components = &set->components;
+        if (components->size + set->sizeBytes > components->capacity)
+        {
+            expand(components, maximum(components->size + set->sizeBytes, components->capacity + components->capacity / 2));
+        }
+        uint8_t* component = components->memory + components->size;
+        std::memset(component, 0, set->sizeBytes);
+        components->size += set->sizeBytes;
+        return component;
+    }
+
+    void ecs_sparse_remove(EcsWorld* world, EcsComponentId componentId, EcsEntityHandle handle)
+    {
+        EcsSparseSet* set = ecs_get_sparse_set(world, componentId);
+        if (!ecs_sparse_get(world, componentId, handle))
+        {
+            return;
+        }
+        uint32_t* position = ecs_access_sparse_position(world, set, ecs_get_entity_handle_index(handle), true);
+        const uint32_t lastPosition = static_cast<uint32_t>(set->handles.size - 1);
+        if (*position != lastPosition)
+        {
+            const EcsEntityHandle lastHandle = *get(&set->handles, lastPosition);
+            *get(&set->handles, *position) = lastHandle;
+            if (set->sizeBytes)
+            {
+                std::memcpy(get(&set->components, *position * set->sizeBytes), get(&set->components, lastPosition * set->sizeBytes), set->sizeBytes);
+            }
+            *ecs_access_sparse_position(world, set, ecs_get_entity_handle_index(lastHandle), true) = *position;
         }
+        *position = ECS_WORLD_INVALID_ENTITY_INDEX;
+        set->handles.size -= 1;
+        set->components.size -= set->sizeBytes;
+        ecs_record_observer_event(world, EcsObserverEvent::REMOVE, componentId, handle);
     }
 
-    EcsEntityHandle ecs_create_entity(EcsWorld* world)
+    void ecs_sparse_remove_entity(EcsWorld* world, EcsEntityHandle handle)
     {
-        EcsEntityHandle handle = world->entities.size;
-        bool pushResult = push(&world->entities,
+        for_each_dynamic_array(world->sparseComponentIds, it)
         {
-            .componentFlags = { },
-            .archetypeHandle = 0,
-            .archetypeArrayIndex = 0
-        });
-        al_assert_msg(pushResult, "Can't create new entity : pool is empty. Consider increasing EngineConfig::ECS_MAX_ENTITIES value.")
-        return handle;
+            ecs_sparse_remove(world, *get(&world->sparseComponentIds, it), handle);
+        }
     }
 
-    template<typename ... T>
-    void ecs_add_components (EcsWorld* world, EcsEntityHandle handle)
+    void ecs_sparse_apply_flags(EcsWorld* world, EcsEntityHandle handle, EcsComponentFlags flags, bool isAdd)
     {
-        ecs_register_components_if_needed<T...>();
-        EcsEntity* entity = get(&world->entities, handle);
-        EcsComponentFlags currentFlags = entity->componentFlags;
-        EcsComponentFlags newFlags = entity->componentFlags;
-        ecs_set_component_flags<T...>(&newFlags);
-        if (currentFlags == newFlags)
+        if (flags == EcsComponentFlags{ })
         {
             return;
         }
-        entity->componentFlags = newFlags;
-        EcsArchetypeHandle oldArchetype = entity->archetypeHandle;
-        EcsArchetypeHandle newArchetype = ecs_match_or_create_archetype(world, handle);
-        ecs_move_entity_superset(world, oldArchetype, newArchetype, handle);
+        for_each_set_flag(flags, it)
+        {
+            if (isAdd)
+            {
+                ecs_sparse_insert(world, it, handle);
+            }
+            else
+            {
+                ecs_sparse_remove(world, it, handle);
+            }
+        }
     }
 
     template<typename ... T>
-    void ecs_remove_components(EcsWorld* world, EcsEntityHandle handle)
+    void ecs_add_sparse_components(EcsWorld* world, EcsEntityHandle handle)
     {
-        ecs_register_components_if_needed<T...>();
-        EcsEntity* entity = get(&world->entities, handle);
-        EcsComponentFlags currentFlags = entity->componentFlags;
-        EcsComponentFlags newFlags = entity->componentFlags;
-        ecs_clear_component_flags<T...>(&newFlags);
-        if (currentFlags == newFlags)
-        {
-            return;
-        }
-        entity->componentFlags = newFlags;
-        EcsArchetypeHandle oldArchetype = entity->archetypeHandle;
-        EcsArchetypeHandle newArchetype = ecs_match_or_create_archetype(world, handle);
-        ecs_move_entity_subset(world, oldArchetype, newArchetype, handle);
+        ((ecs_component_type_info_get_storage<T>() == EcsComponentStorage::SPARSE ? void(ecs_sparse_insert(world, ecs_component_type_info_get_id<T>(), handle)) : void()), ...);
+    }
+
+    template<typename ... T>
+    void ecs_remove_sparse_components(EcsWorld* world, EcsEntityHandle handle)
+    {
+        ((ecs_component_type_info_get_storage<T>() == EcsComponentStorage::SPARSE ? void(ecs_sparse_remove(world, ecs_component_type_info_get_id<T>(), handle)) : void()), ...);
     }
 
     template<typename T>
-    T* ecs_get_component(EcsWorld* world, EcsEntityHandle handle)
+    T* ecs_access_entity_component(EcsWorld* world, EcsEntity* entity, EcsEntityHandle handle)
     {
-        EcsEntity* entity = get(&world->entities, handle);
-        return reinterpret_cast<T*>(ecs_access_component(world, entity->archetypeHandle, ecs_component_type_info_get_id<T>(), entity->archetypeArrayIndex));
+        if constexpr (ecs_component_type_info_get_storage<T>() == EcsComponentStorage::SPARSE)
+        {
+            return reinterpret_cast<T*>(ecs_sparse_get(world, ecs_component_type_info_get_id<T>(), handle));
+        }
+        else
+        {
+            return reinterpret_cast<T*>(ecs_access_component(world, entity->archetypeHandle, ecs_component_type_info_get_id<T>(), entity->archetypeArrayIndex));
+        }
     }
 
-    template<typename ... T>
-    void ecs_for_each_fp(EcsWorld* world, EcsForEachFunctionPointer<T...> func)
+    // @NOTE :  Iteration is driven by the smallest sparse set of requested components, so only entities which
+    //          have this component are visited. Other components are looked up for each visited entity.
+    //          func must not add or remove sparse components of iterated types.
+    template<typename ... T, typename Func>
+    void ecs_for_each_sparse(EcsWorld* world, const EcsArchetypeFilter* filter, Func* func)
     {
-        EcsComponentFlags requestFlags{ };
-        ecs_set_component_flags<T...>(&requestFlags);
-        for_each_array_container(world->archetypes, it)
+        const EcsComponentId sparseIds[] = { (ecs_has_sparse_components<T>() ? ecs_component_type_info_get_id<EcsQueryTermType<T>>() : ECS_WORLD_MAX_COMPONENTS)... };
+        EcsSparseSet* driver = nullptr;
+        for (EcsComponentId componentId : sparseIds)
         {
-            EcsArchetype* archetype = get(&world->archetypes, it);
-            if (!ecs_is_valid_subset(requestFlags, archetype->componentFlags))
+            if (componentId == ECS_WORLD_MAX_COMPONENTS)
             {
                 continue;
             }
-            for (EcsSizeT entityIt = 0; entityIt < archetype->size; entityIt++)
+            EcsSparseSet* set = ecs_get_sparse_set(world, componentId);
+            if (!set)
             {
-                func(world, *get(&archetype->entityHandles, entityIt), ecs_access_component<T>(archetype, entityIt)...);
+                return;
             }
+            driver = !driver || set->handles.size < driver->handles.size ? set : driver;
         }
-    }
-
-    template<typename ... T>
-    void ecs_for_each(EcsWorld* world, EcsForEachFunctionObject<T...> func)
-    {
-        EcsComponentFlags requestFlags{ };
-        ecs_set_component_flags<T...>(&requestFlags);
-        for_each_dynamic_array(world->archetypes, it)
+        for_each_dynamic_array(driver->handles, it)
         {
-            EcsArchetype* archetype = get(&world->archetypes, it);
-            if (!ecs_is_valid_subset(requestFlags, archetype->componentFlags))
+            const EcsEntityHandle handle = *get(&driver->handles, it);
+            EcsEntity* entity = ecs_get_entity(world, handle);
+            EcsArchetype* archetype = ecs_get_archetype(world, entity->archetypeHandle);
+            if (!ecs_is_matching_archetype(filter, archetype->componentFlags))
             {
                 continue;
             }
-            for (EcsSizeT entityIt = 0; entityIt < archetype->size; entityIt++)
+            if (ecs_has_writable_chunk_components<T...>() && entity->archetypeHandle != ECS_WORLD_EMPTY_ARCHETYPE)
             {
-                func(world, *get(&archetype->entityHandles, entityIt), ecs_access_component<T>(archetype, entityIt)...);
+                ecs_get_writable_chunk(world, archetype, entity->archetypeArrayIndex / archetype->singleChunkCapacity);
             }
+            auto process = [&](EcsQueryTermType<T>* ... components)
+            {
+                if (((components || EcsQueryTermTraits<T>::IS_OPTIONAL) && ...))
+                {
+                    (*func)(world, handle, components...);
+                    // @NOTE :  Entities of the empty archetype have only sparse components
+                    const EcsSizeT chunkIndex = archetype->singleChunkCapacity ? entity->archetypeArrayIndex / archetype->singleChunkCapacity : 0;
+                    ((components ? ecs_mark_component_changed<EcsQueryTermType<T>>(world, archetype, chunkIndex) : void()), ...);
+                }
+            };
+            process(ecs_access_entity_component<EcsQueryTermType<T>>(world, entity, handle)...);
         }
     }
 
-    EcsArchetypeHandle ecs_match_or_create_archetype(EcsWorld* world, EcsEntityHandle handle)
+    void ecs_dispatch_jobs_until(JobSystem* jobSystem, std::atomic<EcsSizeT>* finishedJobsNum, EcsSizeT targetJobsNum)
     {
-        EcsEntity* entity = get(&world->entities, handle);
-        for_each_array_container(world->archetypes, it)
+        // @NOTE :  Same helping loop as in wait_for, but jobs are joined with a counter,
+        //          because finished jobs are returned to the pool and can be reused
+        while (finishedJobsNum->load(std::memory_order_acquire) < targetJobsNum)
         {
-            EcsArchetype* archetype = get(&world->archetypes, it);
-            if (archetype->componentFlags == entity->componentFlags)
+            Job* job = get_job_from_queue(jobSystem);
+            if (job)
+            {
+                dispatch(job);
+            }
+            else
             {
-                return archetype->selfHandle;
+                std::this_thread::yield();
             }
         }
-        return ecs_create_archetype(world, entity->componentFlags);
     }
 
-    EcsArchetypeHandle ecs_create_archetype(EcsWorld* world, EcsComponentFlags flags)
+    void ecs_push_command(EcsCommandBuffer* buffer, EcsCommandType type, EcsEntityHandle handle, EcsComponentFlags flags, EcsComponentFlags sparseFlags)
     {
-        EcsArchetype* archetype = push(&world->archetypes);
-        al_assert_msg(archetype, "Can't create new archetype : pool is empty. Consider increasing EngineConfig::ECS_MAX_ARCHETYPES value.");
-        archetype->componentFlags   = flags;
-        archetype->size             = 0;
-        archetype->capacity         = 0;
-        archetype->selfHandle       = index_of(&world->archetypes, archetype);
-        EcsSizeT singleEntrySize = 0;
-        for (EcsSizeT it = 0; it < ECS_WORLD_MAX_COMPONENTS; it++)
+        push(&buffer->commands,
         {
-            if (!archetype->componentFlags.get_flag(it))
-            {
-                continue;
-            }
-            singleEntrySize += gEcsComponentInfos[it].sizeBytes;
+            .type                   = type,
+            .handle                 = handle,
+            .componentFlags         = flags,
+            .sparseComponentFlags   = sparseFlags,
+            .componentId            = 0,
+            .dataOffset             = 0
+        });
+    }
+
+    void ecs_push_command_data(EcsCommandBuffer* buffer, const void* data, EcsSizeT sizeBytes)
+    {
+        DynamicArray<uint8_t>* array = &buffer->data;
+        if (array->size + sizeBytes > array->capacity)
+        {
+            expand(array, maximum(array->size + sizeBytes, array->capacity + array->capacity / 2));
         }
-        archetype->singleChunkCapacity = EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE / singleEntrySize;
-        EcsSizeT currentOffset = 0;
-        for (EcsSizeT it = 0; it < ECS_WORLD_MAX_COMPONENTS; it++)
+        std::memcpy(array->memory + array->size, data, sizeBytes);
+        array->size += sizeBytes;
+    }
+
+    void ecs_clear(EcsCommandBuffer* buffer)
+    {
+        buffer->commands.size = 0;
+        buffer->data.size = 0;
+        buffer->createdEntitiesNum = 0;
+    }
+
+    void ecs_register_query(EcsWorld* world, EcsQueryState* state)
+    {
+        EcsQueryState** result = push(&world->queries, state);
+        al_assert_msg(result, "Can't register ecs query : pool is empty. Consider increasing EngineConfig::ECS_MAX_QUERIES value.");
+        DynamicArray<EcsArchetypeHandle> matchingArchetypes;
+        construct(&matchingArchetypes);
+        ecs_find_matching_archetypes(world, &state->filter, &matchingArchetypes);
+        for_each_dynamic_array(matchingArchetypes, it)
+        {
+            ecs_query_add_archetype(world, state, *get(&matchingArchetypes, it));
+        }
+        destruct(&matchingArchetypes);
+    }
+
+    void ecs_unregister_query(EcsWorld* world, EcsQueryState* state)
+    {
+        for_each_array_container(world->queries, it)
         {
-            if (!archetype->componentFlags.get_flag(it))
+            if (*get(&world->queries, it) == state)
             {
-                continue;
+                remove(&world->queries, it);
+                return;
             }
-            *get(&archetype->componentArrayPointers, it) = currentOffset;
-            currentOffset += gEcsComponentInfos[it].sizeBytes * archetype->singleChunkCapacity;
         }
-        return archetype->selfHandle;
+        al_assert_msg(false, "Query is not registered in this world");
     }
 
-    void ecs_allocate_chunks(EcsWorld* world, EcsArchetypeHandle handle)
+    void ecs_query_try_add_archetype(EcsWorld* world, EcsQueryState* state, EcsArchetypeHandle handle)
     {
-        EcsArchetype* archetype = get(&world->archetypes, handle);
-        push(&archetype->chunks, reinterpret_cast<uint8_t*>(MemoryManager::get_ecs_pool()->allocate(EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE)));
-        archetype->capacity += archetype->singleChunkCapacity;
+        if (handle == ECS_WORLD_EMPTY_ARCHETYPE || !ecs_is_matching_archetype(&state->filter, ecs_get_archetype(world, handle)->componentFlags))
+        {
+            return;
+        }
+        ecs_query_add_archetype(world, state, handle);
     }
 
-    void ecs_move_entity_superset(EcsWorld* world, EcsArchetypeHandle from, EcsArchetypeHandle to, EcsEntityHandle handle)
+    void ecs_query_add_archetype(EcsWorld* world, EcsQueryState* state, EcsArchetypeHandle handle)
     {
-        EcsArchetype*   fromArchetype   = get(&world->archetypes, from);
-        EcsArchetype*   toArchetype     = get(&world->archetypes, to);
-        EcsEntity*      entityPtr       = get(&world->entities, handle);
-        EcsSizeT        fromIndex       = entityPtr->archetypeArrayIndex;
-        EcsSizeT        toIndex         = ecs_reserve_position(world, to);
-        for (EcsSizeT it = 0; it < ECS_WORLD_MAX_COMPONENTS; it++)
+        EcsArchetype* archetype = ecs_get_archetype(world, handle);
+        EcsQueryArchetype queryArchetype{ };
+        queryArchetype.archetypeHandle = handle;
+        for (EcsSizeT it = 0; it < state->componentsNum; it++)
         {
-            if (!fromArchetype->componentFlags.get_flag(it))
-            {
-                continue;
-            }
-            uint8_t* fromComponent = ecs_access_component(world, from, it, fromIndex);
-            uint8_t* toComponent = ecs_access_component(world, to, it, toIndex);
-            std::memcpy(toComponent, fromComponent, gEcsComponentInfos[it].sizeBytes);
+            const bool hasComponent = archetype->componentFlags.get_flag(state->componentIds[it]);
+            queryArchetype.columnOffsets[it] = hasComponent ? archetype->componentArrayPointers[ecs_get_component_index(archetype, state->componentIds[it])] : ECS_QUERY_ABSENT_COLUMN;
+            queryArchetype.versionIndices[it] = hasComponent ? ecs_get_component_index(archetype, state->componentIds[it]) : ECS_QUERY_ABSENT_COLUMN;
         }
-        *get(&toArchetype->entityHandles, toIndex) = handle;
-        ecs_free_position(world, from, fromIndex);
-        entityPtr->archetypeHandle = to;
-        entityPtr->archetypeArrayIndex = toIndex;
+        push(&state->archetypes, queryArchetype);
     }
 
-    void ecs_move_entity_subset(EcsWorld* world, EcsArchetypeHandle from, EcsArchetypeHandle to, EcsEntityHandle handle)
+    bool ecs_is_matching_archetype(const EcsArchetypeFilter* filter, EcsComponentFlags flags)
     {
-        EcsArchetype*   fromArchetype   = get(&world->archetypes, from);
-        EcsArchetype*   toArchetype     = get(&world->archetypes, to);
-        EcsEntity*      entityPtr       = get(&world->entities, handle);
-        EcsSizeT        fromIndex       = entityPtr->archetypeArrayIndex;
-        EcsSizeT        toIndex         = ecs_reserve_position(world, to);
-        for (EcsSizeT it = 0; it < ECS_WORLD_MAX_COMPONENTS; it++)
+        return  filter->allFlags.is_subset_of(flags) &&
+                !filter->noneFlags.intersects(flags) &&
+                (filter->anyFlags.is_empty() || filter->anyFlags.intersects(flags));
+    }
+
+    // @NOTE :  Tests all archetypes (except the empty one) against the filter. Component flags of archetypes
+    //          are packed in world->archetypeMasks, so archetypes are tested over contiguous memory
+    //          (128 bits per SSE2 instruction, see FlagsWide) instead of following archetype pointers.
+    void ecs_find_matching_archetypes(EcsWorld* world, const EcsArchetypeFilter* filter, DynamicArray<EcsArchetypeHandle>* result)
+    {
+        const EcsComponentFlags* masks = world->archetypeMasks.memory;
+        const EcsSizeT masksNum = world->archetypeMasks.size;
+        for (EcsSizeT it = 1; it < masksNum; it++)
         {
-            if (!toArchetype->componentFlags.get_flag(it))
+            if (ecs_is_matching_archetype(filter, masks[it]))
             {
-                continue;
+                push(result, EcsArchetypeHandle{ it });
             }
-            uint8_t* fromComponent = ecs_access_component(world, from, it, fromIndex);
-            uint8_t* toComponent = ecs_access_component(world, to, it, toIndex);
-            std::memcpy(toComponent, fromComponent, gEcsComponentInfos[it].sizeBytes);
         }
-        *get(&toArchetype->entityHandles, toIndex) = handle;
-        ecs_free_position(world, from, fromIndex);
-        entityPtr->archetypeHandle = to;
-        entityPtr->archetypeArrayIndex = toIndex;
     }
 
-    EcsSizeT ecs_reserve_position(EcsWorld* world, EcsArchetypeHandle handle)
+    template<typename ... T>
+    void ecs_apply_query_filter(EcsQueryState* state, EcsWith<T...>)
     {
-        if (handle == ECS_WORLD_EMPTY_ARCHETYPE)
+        static_assert(!ecs_has_sparse_components<T...>(), "Sparse components can't be used in query filters");
+        ecs_register_components_if_needed<T...>();
+        ecs_set_component_flags<T...>(&state->filter.allFlags);
+    }
+
+    template<typename ... T>
+    void ecs_apply_query_filter(EcsQueryState* state, EcsWithout<T...>)
+    {
+        static_assert(!ecs_has_sparse_components<T...>(), "Sparse components can't be used in query filters");
+        ecs_register_components_if_needed<T...>();
+        ecs_set_component_flags<T...>(&state->filter.noneFlags);
+    }
+
+    template<typename ... T>
+    void ecs_apply_query_filter(EcsQueryState* state, EcsAnyOf<T...>)
+    {
+        static_assert(!ecs_has_sparse_components<T...>(), "Sparse components can't be used in query filters");
+        al_assert_msg(state->filter.anyFlags == EcsComponentFlags{ }, "Query can have only one EcsAnyOf filter")
+        ecs_register_components_if_needed<T...>();
+        ecs_set_component_flags<T...>(&state->filter.anyFlags);
+    }
+
+    template<typename T>
+    EcsQueryTermType<T>* ecs_access_query_column(EcsArchetype* archetype, uint8_t* chunk, EcsSizeT columnOffset)
+    {
+        if constexpr (EcsQueryTermTraits<T>::IS_OPTIONAL)
         {
-            return 0;
+            if (columnOffset == ECS_QUERY_ABSENT_COLUMN)
+            {
+                return nullptr;
+            }
         }
-        EcsArchetype* archetype = get(&world->archetypes, handle);
-        EcsSizeT position = archetype->size;
-        archetype->size += 1;
-        if (archetype->size >= archetype->capacity)
+        return ecs_access_column<EcsQueryTermType<T>>(archetype, chunk, columnOffset);
+    }
+
+    template<typename T>
+    EcsQueryTermType<T>* ecs_access_query_row(EcsQueryTermType<T>* column, EcsSizeT index)
+    {
+        if constexpr (EcsQueryTermTraits<T>::IS_OPTIONAL)
         {
-            ecs_allocate_chunks(world, handle);
+            if (!column)
+            {
+                return nullptr;
+            }
         }
-        return position;
+        return ecs_access_row(column, index);
     }
 
-    void ecs_free_position(EcsWorld* world, EcsArchetypeHandle handle, EcsSizeT index)
+    template<typename T>
+    std::span<EcsQueryTermType<T>> ecs_make_query_column_span(EcsQueryTermType<T>* column, EcsSizeT entitiesNum)
     {
-        if (handle == ECS_WORLD_EMPTY_ARCHETYPE)
+        if constexpr (EcsQueryTermTraits<T>::IS_OPTIONAL)
         {
-            return;
+            if (!column)
+            {
+                return { };
+            }
         }
-        EcsArchetype* archetype = get(&world->archetypes, handle);
-        al_assert(archetype->size != 0);
-        if (index == (archetype->size - 1))
+        return ecs_make_column_span(column, entitiesNum);
+    }
+
+    template<typename ... T, typename Func, std::size_t ... Indices>
+    void ecs_for_each_in_query_archetype(EcsWorld* world, EcsQueryState* state, EcsQueryArchetype* queryArchetype, Func* func, std::index_sequence<Indices...>)
+    {
+        EcsArchetype* archetype = ecs_get_archetype(world, queryArchetype->archetypeHandle);
+        for (EcsSizeT firstIndex = 0, chunkIt = 0; firstIndex < archetype->size; firstIndex += archetype->singleChunkCapacity, chunkIt++)
         {
-            for (EcsSizeT it = 0; it < ECS_WORLD_MAX_COMPONENTS; it++)
+            EcsSizeT* chunkVersions = ecs_get_chunk_versions(archetype, chunkIt);
+            if (!ecs_is_chunk_changed(state, chunkVersions, queryArchetype->versionIndices))
             {
-                if (!archetype->componentFlags.get_flag(it))
+                continue;
+            }
+            ecs_mark_components_changed<T...>(world, chunkVersions, queryArchetype->versionIndices, std::index_sequence<Indices...>{ });
+            uint8_t* chunk = ecs_has_writable_chunk_components<T...>() ? ecs_get_writable_chunk(world, archetype, chunkIt) : *get(&archetype->chunks, chunkIt);
+            const EcsSizeT entitiesNum = ecs_get_chunk_entities_num(archetype, chunkIt);
+            const EcsEntityHandle* entityHandles = reinterpret_cast<EcsEntityHandle*>(chunk);
+            auto process = [&](EcsQueryTermType<T>* ... componentArrays)
+            {
+                for (EcsSizeT it = 0; it < entitiesNum; it++)
                 {
-                    continue;
+                    (*func)(world, entityHandles[it], ecs_access_query_row<T>(componentArrays, it)...);
                 }
-                uint8_t* component = ecs_access_component(world, handle, it, index);
-                std::memset(component, 0, gEcsComponentInfos[it].sizeBytes);
-            }
-            archetype->size -= 1;
-            return;
+            };
+            process(ecs_access_query_column<T>(archetype, chunk, queryArchetype->columnOffsets[Indices])...);
         }
-        EcsSizeT lastIndex = archetype->size - 1;
-        for (EcsSizeT it = 0; it < ECS_WORLD_MAX_COMPONENTS; it++)
+    }
+
+    template<typename ... T, typename Func, std::size_t ... Indices>
+    void ecs_for_each_chunk_in_archetype(EcsWorld* world, EcsArchetype* archetype, const EcsSizeT* columnOffsets, const EcsSizeT* versionIndices, const EcsQueryState* state, Func* func, std::index_sequence<Indices...>)
+    {
+        static_assert(!ecs_has_sparse_components<T...>(), "Sparse components are not stored in chunks, so they can't be used in chunk iteration");
+        for (EcsSizeT firstIndex = 0, chunkIt = 0; firstIndex < archetype->size; firstIndex += archetype->singleChunkCapacity, chunkIt++)
         {
-            if (!archetype->componentFlags.get_flag(it))
+            EcsSizeT* chunkVersions = ecs_get_chunk_versions(archetype, chunkIt);
+            if (!ecs_is_chunk_changed(state, chunkVersions, versionIndices))
             {
                 continue;
             }
-            uint8_t* fromComponent = ecs_access_component(world, handle, it, lastIndex);
-            uint8_t* toComponent = ecs_access_component(world, handle, it, index);
-            EcsSizeT sizeBytes = gEcsComponentInfos[it].sizeBytes;
-            std::memcpy(toComponent, fromComponent, sizeBytes);
-            std::memset(fromComponent, 0, sizeBytes);
+            ecs_mark_components_changed<T...>(world, chunkVersions, versionIndices, std::index_sequence<Indices...>{ });
+            uint8_t* chunk = ecs_has_writable_chunk_components<T...>() ? ecs_get_writable_chunk(world, archetype, chunkIt) : *get(&archetype->chunks, chunkIt);
+            const EcsSizeT entitiesNum = ecs_get_chunk_entities_num(archetype, chunkIt);
+            (*func)(world, std::span<EcsEntityHandle>{ reinterpret_cast<EcsEntityHandle*>(chunk), entitiesNum }, ecs_make_query_column_span<T>(ecs_access_query_column<T>(archetype, chunk, columnOffsets[Indices]), entitiesNum)...);
         }
-        EcsEntityHandle* lastHandle = get(&archetype->entityHandles, lastIndex);
-        *get(&archetype->entityHandles, index) = *lastHandle;
-        al_memzero(lastHandle);
-        archetype->size -= 1;
     }
 
-    uint8_t* ecs_access_component(EcsWorld* world, EcsArchetypeHandle handle, EcsComponentId componentId, EcsSizeT index)
+    template<typename ... T, typename Func>
+    void ecs_for_each_chunk_matching(EcsWorld* world, Func* func)
     {
-        EcsArchetype* archetype = get(&world->archetypes, handle);
-        if (!archetype->componentFlags.get_flag(componentId))
+        EcsComponentFlags requestFlags{ };
+        ecs_set_component_flags<T...>(&requestFlags);
+        for_each_dynamic_array(world->archetypes, it)
         {
-            return nullptr;
+            EcsArchetype* archetype = ecs_get_archetype(world, it);
+            if (!ecs_is_valid_subset(requestFlags, archetype->componentFlags))
+            {
+                continue;
+            }
+            const EcsSizeT columnOffsets[] = { archetype->componentArrayPointers[ecs_get_component_index(archetype, ecs_component_type_info_get_id<T>())]... };
+            const EcsSizeT versionIndices[] = { ecs_get_component_index(archetype, ecs_component_type_info_get_id<T>())... };
+            ecs_for_each_chunk_in_archetype<T...>(world, archetype, columnOffsets, versionIndices, nullptr, func, std::index_sequence_for<T...>{ });
         }
-        if (archetype->size <= index)
+    }
+
+    template<typename ... T, typename Func>
+    void ecs_for_each_chunk_in_query(EcsWorld* world, EcsQuery<T...>* query, Func* func)
+    {
+        for_each_dynamic_array(query->state.archetypes, it)
         {
-            return nullptr;
+            EcsQueryArchetype* queryArchetype = get(&query->state.archetypes, it);
+            EcsArchetype* archetype = ecs_get_archetype(world, queryArchetype->archetypeHandle);
+            ecs_for_each_chunk_in_archetype<T...>(world, archetype, queryArchetype->columnOffsets, queryArchetype->versionIndices, &query->state, func, std::index_sequence_for<T...>{ });
         }
-        EcsSizeT chunkIndex = index / archetype->singleChunkCapacity;
-        EcsSizeT inChunkIndex = index % archetype->singleChunkCapacity;
-        return *get(&archetype->chunks, chunkIndex) + *get(&archetype->componentArrayPointers, componentId) + inChunkIndex * gEcsComponentInfos[componentId].sizeBytes;
+        ecs_finish_query_iteration(world, &query->state);
     }
 
     template<typename T>
-    T* ecs_access_component(EcsArchetype* archetype, EcsSizeT index)
+    inline EcsComponentId ecs_component_type_info_get_id()
     {
-        EcsSizeT chunkIndex = index / archetype->singleChunkCapacity;
-        EcsSizeT inChunkIndex = index % archetype->singleChunkCapacity;
-        EcsComponentId componentId = ecs_component_type_info_get_id<T>();
-        uint8_t* memory = *get(&archetype->chunks, chunkIndex) + *get(&archetype->componentArrayPointers, componentId) + inChunkIndex * gEcsComponentInfos[componentId].sizeBytes;
-        return reinterpret_cast<T*>(memory);
-    };
+        // @NOTE :  Const components (read-only access) share id with non-const ones
+        if constexpr (std::is_const_v<T>)
+        {
+            return ecs_component_type_info_get_id<std::remove_const_t<T>>();
+        }
+        else
+        {
+            const EcsComponentId id = gEcsComponentIdCache<T>.load(std::memory_order_acquire);
+            if (id != ECS_WORLD_MAX_COMPONENTS) [[likely]]
+            {
+                return id;
+            }
+            ecs_register_component<T>();
+            return gEcsComponentIdCache<T>.load(std::memory_order_acquire);
+        }
+    }
 
     template<typename T>
-    inline EcsComponentId ecs_component_type_info_get_id()
+    inline EcsSizeT ecs_component_type_info_get_size()
     {
-        static EcsComponentId id = gEcsComponentCount++;
-        return id;
+        // @NOTE :  sizeof of empty type is one, but tags don't take any memory
+        return std::is_empty_v<T> ? 0 : sizeof(T);
     }
 
     template<typename T>
-    inline EcsSizeT ecs_component_type_info_get_size()
+    inline EcsSizeT ecs_component_type_info_get_alignment()
     {
-        return sizeof(T);
+        static_assert(alignof(T) <= minimum(lowest_set_bit(EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE), EngineConfig::CACHE_LINE_SIZE), "Component alignment is bigger than chunk alignment");
+        return maximum(EcsSizeT{ alignof(T) }, EcsSizeT{ EngineConfig::ECS_COMPONENT_ARRAY_ALIGNMENT });
     }
 
-    // @NOTE :  Component size of zero is considered invalid.
     template<typename T>
     inline bool ecs_is_component_registered()
     {
-        return gEcsComponentInfos[ecs_component_type_info_get_id<T>()].sizeBytes != 0;
+        return gEcsComponentIdCache<std::remove_const_t<T>>.load(std::memory_order_acquire) != ECS_WORLD_MAX_COMPONENTS;
     }
 
     template<typename T, typename ... U> bool ecs_is_components_registered(bool value)
@@ -354,7 +2780,7 @@ namespace al::engine
         bool result = value && ecs_is_component_registered<T>();
         if constexpr (sizeof...(U) != 0)
         {
-            result = result && is_components_registered<U...>();
+            result = result && ecs_is_components_registered<U...>();
         }
         return result;
     }
@@ -362,8 +2788,10 @@ namespace al::engine
     template<typename T>
     inline void ecs_register_component()
     {
-        al_assert(ecs_component_type_info_get_id<T>() < ECS_WORLD_MAX_COMPONENTS);
-        gEcsComponentInfos[ecs_component_type_info_get_id<T>()].sizeBytes = ecs_component_type_info_get_size<T>();
+        static_assert(ecs_component_type_info_get_storage<T>() != EcsComponentStorage::SPARSE || alignof(T) <= alignof(void*), "Sparse components are stored in pool allocator arrays, which are not aligned to more than pointer size");
+        const EcsComponentId id = ecs_acquire_component_id(ecs_component_type_info_get_hash<T>(), ecs_component_type_info_get_size<T>(), ecs_component_type_info_get_alignment<T>(), ecs_component_type_info_get_storage<T>());
+        al_assert(id < ECS_WORLD_MAX_COMPONENTS);
+        gEcsComponentIdCache<std::remove_const_t<T>>.store(id, std::memory_order_release);
     }
 
     template<typename T, typename ... U>
@@ -379,16 +2807,33 @@ namespace al::engine
         }
     }
 
+    // @NOTE :  Sets archetype flags of components. Sparse components are not stored in archetypes, so they are skipped.
     template<typename T, typename ... U>
     void ecs_set_component_flags(EcsComponentFlags* flags)
     {
-        flags->set_flag(ecs_component_type_info_get_id<T>());
+        if constexpr (ecs_component_type_info_get_storage<T>() != EcsComponentStorage::SPARSE)
+        {
+            flags->set_flag(ecs_component_type_info_get_id<T>());
+        }
         if constexpr (sizeof...(U) != 0)
         {
             ecs_set_component_flags<U...>(flags);
         }
     }
 
+    template<typename T, typename ... U>
+    void ecs_set_sparse_component_flags(EcsComponentFlags* flags)
+    {
+        if constexpr (ecs_component_type_info_get_storage<T>() == EcsComponentStorage::SPARSE)
+        {
+            flags->set_flag(ecs_component_type_info_get_id<T>());
+        }
+        if constexpr (sizeof...(U) != 0)
+        {
+            ecs_set_sparse_component_flags<U...>(flags);
+        }
+    }
+
     template<typename T, typename ... U>
     void ecs_clear_component_flags(EcsComponentFlags* flags)
     {
@@ -399,9 +2844,101 @@ namespace al::engine
         }
     }
 
+    // @NOTE :  Splits handles into runs of consecutive entities which are stored in the same archetype
+    template<typename Func>
+    void ecs_for_each_archetype_run(EcsWorld* world, std::span<const EcsEntityHandle> handles, Func func)
+    {
+        EcsSizeT runBegin = 0;
+        while (runBegin < handles.size())
+        {
+            const EcsArchetypeHandle archetype = ecs_get_entity(world, handles[runBegin])->archetypeHandle;
+            EcsSizeT runEnd = runBegin + 1;
+            while (runEnd < handles.size() && ecs_get_entity(world, handles[runEnd])->archetypeHandle == archetype)
+            {
+                runEnd++;
+            }
+            func(archetype, handles.subspan(runBegin, runEnd - runBegin));
+            runBegin = runEnd;
+        }
+    }
+
+    template<typename T, typename ... U>
+    EcsArchetypeHandle ecs_follow_add_edges(EcsWorld* world, EcsArchetypeHandle handle)
+    {
+        if constexpr (ecs_component_type_info_get_storage<T>() != EcsComponentStorage::SPARSE)
+        {
+            handle = ecs_get_add_edge(world, handle, ecs_component_type_info_get_id<T>());
+        }
+        if constexpr (sizeof...(U) != 0)
+        {
+            handle = ecs_follow_add_edges<U...>(world, handle);
+        }
+        return handle;
+    }
+
+    template<typename T, typename ... U>
+    EcsArchetypeHandle ecs_follow_remove_edges(EcsWorld* world, EcsArchetypeHandle handle)
+    {
+        if constexpr (ecs_component_type_info_get_storage<T>() != EcsComponentStorage::SPARSE)
+        {
+            handle = ecs_get_remove_edge(world, handle, ecs_component_type_info_get_id<T>());
+        }
+        if constexpr (sizeof...(U) != 0)
+        {
+            handle = ecs_follow_remove_edges<U...>(world, handle);
+        }
+        return handle;
+    }
+
     bool ecs_is_valid_subset(EcsComponentFlags subset, EcsComponentFlags superset)
     {
-        return  ((subset.flags[0] & superset.flags[0]) == subset.flags[0]) &&
-                ((subset.flags[1] & superset.flags[1]) == subset.flags[1]);
+        return subset.is_subset_of(superset);
+    }
+
+    // @NOTE :  Thread which claims the slot fills component info. Other threads which register the same
+    //          type at the same time wait until the info is published (this takes a few stores).
+    EcsComponentId ecs_acquire_component_id(uint64_t typeHash, EcsSizeT sizeBytes, EcsSizeT alignment, EcsComponentStorage storage)
+    {
+        for (EcsSizeT it = 0; it < ECS_WORLD_MAX_COMPONENTS; it++)
+        {
+            const EcsComponentId id = (typeHash + it) % ECS_WORLD_MAX_COMPONENTS;
+            uint64_t slotHash = 0;
+            if (gEcsComponentTypeHashes[id].compare_exchange_strong(slotHash, typeHash, std::memory_order_acq_rel))
+            {
+                EcsComponentRuntimeInfo* info = &gEcsComponentInfos[id];
+                info->sizeBytes = sizeBytes;
+                info->alignment = alignment;
+                info->storage   = storage;
+                info->typeHash  = typeHash;
+                info->isRegistered.store(true, std::memory_order_release);
+                return id;
+            }
+            if (slotHash == typeHash)
+            {
+                while (!gEcsComponentInfos[id].isRegistered.load(std::memory_order_acquire)) { }
+                return id;
+            }
+        }
+        al_assert_msg(false, "Too many component types. Consider increasing EngineConfig::ECS_COMPONENT_FLAGS_BITS value.");
+        return ECS_WORLD_MAX_COMPONENTS;
+    }
+
+    // @NOTE :  Returns ECS_WORLD_MAX_COMPONENTS if type with this hash is not registered
+    EcsComponentId ecs_find_component_id(uint64_t typeHash)
+    {
+        for (EcsSizeT it = 0; it < ECS_WORLD_MAX_COMPONENTS; it++)
+        {
+            const EcsComponentId id = (typeHash + it) % ECS_WORLD_MAX_COMPONENTS;
+            const uint64_t slotHash = gEcsComponentTypeHashes[id].load(std::memory_order_acquire);
+            if (slotHash == typeHash)
+            {
+                return id;
+            }
+            if (slotHash == 0)
+            {
+                break;
+            }
+        }
+        return ECS_WORLD_MAX_COMPONENTS;
     }
 }
@@ -2,14 +2,23 @@
 #define AL_ECS_H
 
 #include <cstdint>
+#include <cstdio>   // for std::FILE
+#include <atomic>   // for std::atomic
+#include <utility>  // for std::index_sequence
+#include <span>     // for std::span
+#include <type_traits>  // for std::is_empty_v, std::is_base_of_v
+#include <string_view>  // for std::string_view
 
 #include "engine/config/engine_config.h"
 #include "engine/memory/memory_common.h"
 #include "engine/debug/debug.h"
 #include "engine/containers/containers.h"
+#include "engine/job_system/job_system.h"
+#include "engine/platform/platform_file_mapping.h"
 
 #include "utilities/flags.h"
 #include "utilities/function.h"
+#include "utilities/constexpr_functions.h"
 
 namespace al::engine
 {
@@ -17,56 +26,435 @@ namespace al::engine
     using EcsEntityHandle       = EcsSizeT;
     using EcsArchetypeHandle    = EcsSizeT;
     using EcsComponentId        = EcsSizeT;
-    using EcsComponentFlags     = Flags128;
+    using EcsComponentFlags     = FlagsWide<EngineConfig::ECS_COMPONENT_FLAGS_BITS>;
 
+    // @NOTE :  Components can be requested as const (e.g. EcsForEachFunctionObject<const Position>), in this case
+    //          iteration doesn't mark them as changed (see ecs_set_changed_filter)
     template<typename ... T> using EcsForEachFunctionPointer    = void(*)(struct EcsWorld*, EcsEntityHandle, T*...);
     template<typename ... T> using EcsForEachFunctionObject     = Function<void(struct EcsWorld*, EcsEntityHandle, T*...)>;
 
-    // @NOTE :  Must correlate with EcsComponentFlags type.
-    //          One is subtracted because ComponentCounter::count
-    //          value starts from one, not zero.
-    constexpr EcsSizeT              ECS_WORLD_MAX_COMPONENTS    = 128 - 1;
+    template<typename ... T> using EcsForEachChunkFunctionPointer   = void(*)(struct EcsWorld*, std::span<EcsEntityHandle>, std::span<T>...);
+    template<typename ... T> using EcsForEachChunkFunctionObject    = Function<void(struct EcsWorld*, std::span<EcsEntityHandle>, std::span<T>...)>;
+
+    using EcsObserverFunctionPointer = void(*)(struct EcsWorld*, std::span<const EcsEntityHandle>, void* userData);
+
+    // @NOTE :  Width of EcsComponentFlags is set by EngineConfig::ECS_COMPONENT_FLAGS_BITS.
+    //          Component ids are in [0, ECS_WORLD_MAX_COMPONENTS) range, ECS_WORLD_MAX_COMPONENTS
+    //          itself is used as invalid component id.
+    constexpr EcsSizeT              ECS_WORLD_MAX_COMPONENTS    = EcsComponentFlags::BITS_NUM - 1;
     constexpr EcsArchetypeHandle    ECS_WORLD_EMPTY_ARCHETYPE   = 0 ;
+    constexpr EcsArchetypeHandle    ECS_WORLD_INVALID_ARCHETYPE = ~EcsArchetypeHandle{ 0 };
+    constexpr uint32_t              ECS_WORLD_INVALID_ENTITY_INDEX = ~uint32_t{ 0 };
+    // @NOTE :  Entities created by EcsCommandBuffer get this generation until the buffer is executed.
+    //          Real entities never use it (see ecs_release_entity).
+    constexpr uint32_t              ECS_PENDING_ENTITY_GENERATION  = ~uint32_t{ 0 };
+
+    // @NOTE :  Entity handle stores entity index in the lower 32 bits and entity generation in the
+    //          upper 32 bits. Generation is incremented when entity is destroyed, so handles of
+    //          destroyed entities can be detected even if index was reused.
+    constexpr EcsEntityHandle   ecs_make_entity_handle          (uint32_t index, uint32_t generation)   { return (EcsEntityHandle{ generation } << 32) | EcsEntityHandle{ index }; }
+    constexpr uint32_t          ecs_get_entity_handle_index     (EcsEntityHandle handle)                { return static_cast<uint32_t>(handle & 0xFFFFFFFF); }
+    constexpr uint32_t          ecs_get_entity_handle_generation(EcsEntityHandle handle)                { return static_cast<uint32_t>(handle >> 32); }
 
-    extern        EcsComponentId            gEcsComponentCount;
+    // @NOTE :  Initial size of the open addressing table which maps component flags to archetypes.
+    //          Table size is doubled when it becomes half full, so probe sequences stay short.
+    constexpr EcsSizeT              ECS_WORLD_ARCHETYPE_LOOKUP_INITIAL_SIZE = 64;
+
+    // @NOTE :  Component id is a slot of gEcsComponentTypeHashes which stores hash of the component type name
+    //          (see ecs_component_type_info_get_hash). Search for the slot starts at hash % ECS_WORLD_MAX_COMPONENTS
+    //          and free slot is claimed with compare-exchange, so components can be registered from any thread
+    //          without locks. Ids don't depend on registration order unless two types hash to the same slot,
+    //          so serialized data should store type hashes and map them to ids with ecs_find_component_id.
+    extern std::atomic<uint64_t>            gEcsComponentTypeHashes[ECS_WORLD_MAX_COMPONENTS];
     extern struct EcsComponentRuntimeInfo   gEcsComponentInfos[ECS_WORLD_MAX_COMPONENTS];
 
+    // @NOTE :  Storage of component is defined by it's type (see ecs_component_type_info_get_storage).
+    //          CHUNK - component array in each archetype chunk (default).
+    //          TAG - empty types. Tag is stored only in archetype component flags and takes no memory.
+    //          SHARED - types derived from EcsSharedComponent. Single value is stored per archetype.
+    //          SPARSE - types derived from EcsSparseComponent. Component is stored in a sparse set beside archetypes,
+    //          so adding and removing it doesn't move the entity between archetypes.
+    enum class EcsComponentStorage : uint8_t
+    {
+        CHUNK,
+        TAG,
+        SHARED,
+        SPARSE
+    };
+
+    // @NOTE :  Base type for shared components (e.g. struct Material : EcsSharedComponent { ... }).
+    //          All entities of an archetype see the same value of shared component, so writing it through
+    //          one entity changes it for the whole archetype. Archetypes which are created by adding or removing
+    //          components copy shared values of the source archetype, other archetypes start with zeroed values.
+    struct EcsSharedComponent { };
+
+    // @NOTE :  Base type for frequently added and removed components (e.g. struct Selected : EcsSparseComponent { }).
+    //          Sparse components can be empty. They can't be used in chunk iteration, ecs_for_each_parallel and
+    //          changed filters. Iteration with sparse components visits only entities of the smallest sparse set.
+    struct EcsSparseComponent { };
+
+    // @NOTE :  Query terms. Query component can be wrapped into EcsOptional<T> : archetypes without T also
+    //          match and nullptr (or empty chunk span) is passed instead of the component.
+    //          Filters are passed to query construct (e.g. construct<EcsWithout<Frozen>>(&query, world)) and
+    //          don't give access to components. EcsWith<T...> - archetype must have all of T, EcsWithout<T...> -
+    //          archetype must have none of T, EcsAnyOf<T...> - archetype must have at least one of T.
+    template<typename T>        struct EcsOptional  { };
+    template<typename ... T>    struct EcsWith      { };
+    template<typename ... T>    struct EcsWithout   { };
+    template<typename ... T>    struct EcsAnyOf     { };
+
+    template<typename T>
+    struct EcsQueryTermTraits
+    {
+        using Type = T;
+        static constexpr bool IS_OPTIONAL = false;
+    };
+
+    template<typename T>
+    struct EcsQueryTermTraits<EcsOptional<T>>
+    {
+        using Type = T;
+        static constexpr bool IS_OPTIONAL = true;
+    };
+
+    template<typename T> using EcsQueryTermType = typename EcsQueryTermTraits<T>::Type;
+
+    // @NOTE :  Storage is used in if constexpr branches of iteration templates, so it is defined here
+    template<typename T>
+    constexpr EcsComponentStorage ecs_component_type_info_get_storage()
+    {
+        if constexpr (std::is_base_of_v<EcsSparseComponent, T>)
+        {
+            return EcsComponentStorage::SPARSE;
+        }
+        else if constexpr (std::is_empty_v<T>)
+        {
+            return EcsComponentStorage::TAG;
+        }
+        else if constexpr (std::is_base_of_v<EcsSharedComponent, T>)
+        {
+            return EcsComponentStorage::SHARED;
+        }
+        else
+        {
+            return EcsComponentStorage::CHUNK;
+        }
+    }
+
+    // @NOTE :  Name of the type as written by the compiler in the function signature (e.g. "al::engine::Position").
+    //          Spelling differs between compilers, but doesn't change between runs and builds of the program.
+    template<typename T>
+    constexpr std::string_view ecs_component_type_info_get_name()
+    {
+        const std::string_view signature = al_function_signature;
+#ifdef _MSC_VER
+        const std::string_view prefix = "ecs_component_type_info_get_name<";
+        const std::size_t begin = signature.find(prefix) + prefix.size();
+        return signature.substr(begin, signature.rfind(">(void)") - begin);
+#else
+        const std::string_view prefix = "T = ";
+        const std::size_t begin = signature.find(prefix) + prefix.size();
+        return signature.substr(begin, signature.find_first_of(";]", begin) - begin);
+#endif
+    }
+
+    // @NOTE :  Zero marks free slot of gEcsComponentTypeHashes, so it is never returned
+    template<typename T>
+    constexpr uint64_t ecs_component_type_info_get_hash()
+    {
+        constexpr std::string_view name = ecs_component_type_info_get_name<std::remove_const_t<T>>();
+        constexpr uint64_t hash = fnv1a_64(name.data(), name.size());
+        return hash ? hash : 1;
+    }
+
+    template<typename ... T>
+    constexpr bool ecs_has_sparse_components()
+    {
+        return ((ecs_component_type_info_get_storage<EcsQueryTermType<T>>() == EcsComponentStorage::SPARSE) || ...);
+    }
+
+    template<typename ... T>
+    constexpr bool ecs_has_writable_chunk_components()
+    {
+        return ((!std::is_const_v<EcsQueryTermType<T>> && ecs_component_type_info_get_storage<std::remove_const_t<EcsQueryTermType<T>>>() == EcsComponentStorage::CHUNK) || ...);
+    }
+
     struct al_align EcsComponentRuntimeInfo
     {
-        EcsSizeT sizeBytes = 0;
+        EcsSizeT            sizeBytes = 0;      // Zero for tags
+        EcsSizeT            alignment = 0;      // Alignment of component array in chunk : max(alignof(T), ECS_COMPONENT_ARRAY_ALIGNMENT)
+        EcsComponentStorage storage = EcsComponentStorage::CHUNK;
+        uint64_t            typeHash = 0;       // See ecs_component_type_info_get_hash
+        std::atomic<bool>   isRegistered = false;
     };
 
     // @NOTE :  EcsEntity has the following data.
-    //          componentFlags - describes the components that this entity has.
-    //          archetypeHandle - handle to an archetype which stores this entity.
+    //          archetypeHandle - handle to an archetype which stores this entity (archetype
+    //          component flags describe the components that this entity has).
     //          archetypeArrayIndex - index af entity components in archetype component arrays.
+    //          generation - generation of the entity which currently uses this index.
+    //          nextFreeIndex - next index in the free list (valid only for destroyed entities).
     struct al_align EcsEntity
     {
-        EcsComponentFlags   componentFlags;
         EcsArchetypeHandle  archetypeHandle;
         EcsSizeT            archetypeArrayIndex;
+        uint32_t            generation;
+        uint32_t            nextFreeIndex;
     };
 
+    // @NOTE :  Entities are stored in pages of ecs pool chunk size, so entity table grows
+    //          without moving existing entities
+    constexpr EcsSizeT              ECS_WORLD_ENTITIES_IN_PAGE = EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE / sizeof(EcsEntity);
+
+    // @NOTE :  Archetype transition to the archetype with one more component
+    struct EcsArchetypeEdge
+    {
+        EcsComponentId      componentId;
+        EcsArchetypeHandle  archetypeHandle;
+    };
+
+    // @NOTE :  Each archetype is allocated separately from the pool allocator together with it's
+    //          componentArrayPointers and removeEdges tables (see ecs_get_archetype_allocation_size),
+    //          so pointers to archetypes stay valid when new archetypes are created.
+    //          Tables have componentsNum entries and are indexed by component index - number of archetype
+    //          components with lower id (see ecs_get_component_index), so archetype size doesn't depend
+    //          on ECS_WORLD_MAX_COMPONENTS. Add edges lead to components which archetype doesn't have,
+    //          so only known transitions are stored and searched linearly.
+    //          Entity handles are stored in chunks, in front of component arrays (see ecs_compute_chunk_layout).
+    //          For shared components componentArrayPointers stores offset of the value in sharedComponents.
     struct al_align EcsArchetype
     {
-        EcsComponentFlags                                                               componentFlags;         // 16
-        EcsArchetypeHandle                                                              selfHandle;             // 8
-        EcsSizeT                                                                        size;                   // 8
-        EcsSizeT                                                                        capacity;               // 8
-        EcsSizeT                                                                        singleChunkCapacity;    // 8
-        ArrayView<EcsSizeT, ECS_WORLD_MAX_COMPONENTS>                                   componentArrayPointers; // 8
-        ArrayView<EcsEntityHandle, EngineConfig::ECS_MAX_ENTITIES_IN_ARCHETYPE_CHUNK>   entityHandles;          // 8
-        DynamicArray<uint8_t*>                                                          chunks;                 // 32
+        EcsComponentFlags                                           componentFlags;         // ECS_COMPONENT_FLAGS_BITS / 8
+        EcsComponentFlags                                           chunkComponentFlags;    // ECS_COMPONENT_FLAGS_BITS / 8 : components which have arrays in chunks (no tags and shared components)
+        EcsArchetypeHandle                                          selfHandle;             // 8
+        EcsSizeT                                                    size;                   // 8
+        EcsSizeT                                                    capacity;               // 8
+        EcsSizeT                                                    singleChunkCapacity;    // 8
+        EcsSizeT*                                                   componentArrayPointers; // 8 : componentsNum entries
+        EcsArchetypeHandle*                                         removeEdges;            // 8 : componentsNum entries
+        DynamicArray<EcsArchetypeEdge>                              addEdges;               // 32
+        DynamicArray<uint8_t*>                                      chunks;                 // 32
+        DynamicArray<EcsSizeT>                                      chunkVersions;          // 32 : componentsNum change versions per chunk (see ecs_get_chunk_versions)
+        EcsSizeT                                                    componentsNum;          // 8
+        uint8_t*                                                    sharedComponents;       // 8 : values of shared components, allocated from the pool allocator
+        EcsSizeT                                                    sharedComponentsSize;   // 8
+    };
+
+    // @NOTE :  Sparse set of a single component. Pages map entity index to position in dense arrays
+    //          (ECS_WORLD_INVALID_ENTITY_INDEX if entity doesn't have the component). Pages are allocated
+    //          from the ecs pool when entity with index from this page gets the component.
+    //          Components are removed by moving the last dense element into the hole.
+    constexpr EcsSizeT ECS_SPARSE_SET_POSITIONS_IN_PAGE = EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE / sizeof(uint32_t);
+
+    struct EcsSparseSet
+    {
+        DynamicArray<uint32_t*>         pages;          // Unallocated pages are nullptr
+        DynamicArray<EcsEntityHandle>   handles;        // Dense array of entity handles
+        DynamicArray<uint8_t>           components;     // Dense array of component values (empty for sparse tags)
+        EcsSizeT                        sizeBytes;
+    };
+
+    constexpr EcsSizeT ecs_get_archetype_allocation_size(EcsSizeT componentsNum) { return sizeof(EcsArchetype) + (sizeof(EcsSizeT) + sizeof(EcsArchetypeHandle)) * componentsNum; }
+
+    // @NOTE :  Payload of a job which processes single archetype chunk in ecs_for_each_parallel
+    template<typename ... T>
+    struct EcsForEachChunkJobPayload
+    {
+        struct EcsWorld*                    world;
+        EcsArchetype*                       archetype;
+        EcsSizeT                            chunkIndex;
+        EcsForEachFunctionObject<T...>*     func;
+        std::atomic<EcsSizeT>*              finishedJobsNum;
+    };
+
+    // @NOTE :  Column offset and version index of EcsOptional component which archetype doesn't have
+    constexpr EcsSizeT ECS_QUERY_ABSENT_COLUMN = ~EcsSizeT{ 0 };
+
+    // @NOTE :  Archetype matches the filter if it has all components of allFlags, none of noneFlags
+    //          and at least one of anyFlags (if anyFlags is not empty)
+    struct EcsArchetypeFilter
+    {
+        EcsComponentFlags allFlags;
+        EcsComponentFlags noneFlags;
+        EcsComponentFlags anyFlags;
+    };
+
+    struct EcsQueryArchetype
+    {
+        EcsArchetypeHandle  archetypeHandle;
+        EcsSizeT            columnOffsets[EngineConfig::ECS_QUERY_MAX_COMPONENTS];  // Offsets of component arrays in archetype chunks, in query components order
+        EcsSizeT            versionIndices[EngineConfig::ECS_QUERY_MAX_COMPONENTS]; // Indices of component change versions in chunk versions, in query components order
+    };
+
+    // @NOTE :  Non-template part of EcsQuery. World keeps pointers to all query states and
+    //          adds new matching archetypes to them in ecs_create_archetype, so query never
+    //          needs to test all world archetypes again.
+    struct EcsQueryState
+    {
+        EcsArchetypeFilter              filter;
+        EcsComponentId                  componentIds[EngineConfig::ECS_QUERY_MAX_COMPONENTS];
+        EcsSizeT                        componentsNum;
+        DynamicArray<EcsQueryArchetype> archetypes;
+        EcsSizeT                        changedFilterMask;  // Bit per query component (in query components order), see ecs_set_changed_filter
+        EcsSizeT                        lastRunVersion;     // World change version at the end of the previous iteration
+    };
+
+    template<typename ... T>
+    struct EcsQuery
+    {
+        EcsQueryState state;
+    };
+
+    enum class EcsCommandType : uint8_t
+    {
+        CREATE,
+        DESTROY,
+        ADD,
+        REMOVE,
+        SET
+    };
+
+    struct EcsCommand
+    {
+        EcsCommandType      type;
+        EcsEntityHandle     handle;                 // Might be a pending handle of an entity created by the same buffer
+        EcsComponentFlags   componentFlags;         // ADD and REMOVE commands : archetype components
+        EcsComponentFlags   sparseComponentFlags;   // ADD and REMOVE commands : sparse components
+        EcsComponentId      componentId;            // SET command
+        EcsSizeT            dataOffset;             // SET command : offset of the component value in EcsCommandBuffer::data
+    };
+
+    // @NOTE :  Records structural changes, so they can be made from parallel jobs and applied later
+    //          on a single thread with ecs_execute_command_buffers. Buffer is not thread safe -
+    //          each thread (or job) must record to it's own buffer.
+    struct EcsCommandBuffer
+    {
+        DynamicArray<EcsCommand>    commands;
+        DynamicArray<uint8_t>       data;
+        EcsSizeT                    createdEntitiesNum;
+    };
+
+    enum class EcsObserverEvent : uint8_t
+    {
+        ADD,
+        REMOVE,
+        SET,
+        __end
     };
 
+    struct EcsObserver
+    {
+        EcsObserverFunctionPointer  func;
+        void*                       userData;
+        EcsComponentId              componentId;
+        EcsObserverEvent            event;
+    };
+
+    struct EcsObserverEventRecord
+    {
+        EcsEntityHandle     handle;
+        EcsComponentId      componentId;
+        EcsObserverEvent    event;
+    };
+
+    // @NOTE :  World tables grow on demand, so an empty world takes a few kilobytes.
+    //          Archetype transition graph is stored in archetype addEdges and removeEdges tables.
+    //          Edge for component id points to the archetype with this component added (or removed).
+    //          ECS_WORLD_INVALID_ARCHETYPE means that edge is not resolved yet.
     struct al_align EcsWorld
     {
-        // Theese pools are used in archetypes
-        EcsSizeT        componentArrayPointersPool  [ECS_WORLD_MAX_COMPONENTS * EngineConfig::ECS_MAX_ARCHETYPES];
-        EcsEntityHandle entityHandlesPool           [EngineConfig::ECS_MAX_ENTITIES_IN_ARCHETYPE_CHUNK * EngineConfig::ECS_MAX_ARCHETYPES];
+        DynamicArray<EcsEntity*>                                        entityPages;        // Pages of ECS_WORLD_ENTITIES_IN_PAGE entities
+        EcsSizeT                                                        entitiesNum;        // Number of used entity indices (including destroyed entities)
+        uint32_t                                                        freeEntitiesHead;   // First index in the free list of destroyed entities
+        DynamicArray<EcsArchetype*>                                     archetypes;
+        DynamicArray<EcsComponentFlags>                                 archetypeMasks;     // Component flags of all archetypes packed together, see ecs_find_matching_archetypes
+        // @NOTE :  Empty archetype is never stored in this table, so ECS_WORLD_EMPTY_ARCHETYPE marks unused slots
+        EcsArchetypeHandle*                                             archetypeLookup;
+        EcsSizeT                                                        archetypeLookupSize;
+        ArrayContainer<EcsQueryState*, EngineConfig::ECS_MAX_QUERIES>   queries;
+        // @NOTE :  Written chunk columns are marked with current change version. Version is incremented
+        //          after each query iteration, so query can skip chunks which were not changed since it's
+        //          previous iteration (see ecs_set_changed_filter).
+        EcsSizeT                                                        changeVersion;
+        // @NOTE :  Singleton values by component id, allocated from the pool allocator in ecs_set_singleton
+        uint8_t*                                                        singletons[ECS_WORLD_MAX_COMPONENTS];
+        // @NOTE :  Sparse sets by component id, created when sparse component is added for the first time
+        EcsSparseSet*                                                   sparseSets[ECS_WORLD_MAX_COMPONENTS];
+        DynamicArray<EcsComponentId>                                    sparseComponentIds; // Ids of created sparse sets
+        // @NOTE :  Snapshot file loaded with ecs_load_snapshot. Chunks and entity pages can point into the mapping,
+        //          such memory is not returned to the ecs pool (see ecs_is_snapshot_memory)
+        FileMapping                                                     snapshot;
+        // @NOTE :  Events are recorded only for observed components (see observedComponents) and are
+        //          delivered to observers in batches by ecs_flush_observers
+        ArrayContainer<EcsObserver, EngineConfig::ECS_MAX_OBSERVERS>    observers;
+        EcsComponentFlags                                               observedComponents[static_cast<EcsSizeT>(EcsObserverEvent::__end)];
+        DynamicArray<EcsObserverEventRecord>                            observerEvents;
+        bool                                                            isFlushingObservers;
+    };
+
+    // @NOTE :  Snapshot file layout. Header is followed by archetype, component, sparse set and singleton records,
+    //          data section (shared component values, sparse sets and singletons), entity pages and archetype chunks.
+    //          Entity pages and chunks are stored as is at offsets aligned to chunk size, so they can be used
+    //          right from the mapped file. Offsets in records are counted from the beginning of the data section.
+    constexpr uint64_t ECS_SNAPSHOT_MAGIC   = 0x544F4853504E5345ULL;    // "ESNPSHOT"
+    constexpr uint32_t ECS_SNAPSHOT_VERSION = 1;
+
+    struct EcsSnapshotHeader
+    {
+        uint64_t    magic;
+        uint32_t    version;
+        uint32_t    chunkSize;
+        EcsSizeT    entitySize;
+        EcsSizeT    fileSize;
+        EcsSizeT    entitiesNum;
+        EcsSizeT    freeEntitiesHead;
+        EcsSizeT    changeVersion;
+        EcsSizeT    entityPagesNum;
+        EcsSizeT    archetypesNum;          // Empty archetype is not stored
+        EcsSizeT    componentsNum;          // Component records of all archetypes
+        EcsSizeT    sparseSetsNum;
+        EcsSizeT    singletonsNum;
+        EcsSizeT    archetypesOffset;
+        EcsSizeT    componentsOffset;
+        EcsSizeT    sparseSetsOffset;
+        EcsSizeT    singletonsOffset;
+        EcsSizeT    dataOffset;
+        EcsSizeT    entityPagesOffset;
+        EcsSizeT    chunksOffset;
+    };
+
+    struct EcsSnapshotArchetype
+    {
+        EcsSizeT    size;
+        EcsSizeT    singleChunkCapacity;
+        EcsSizeT    firstChunk;             // Index of the first chunk in the chunks section
+        EcsSizeT    chunksNum;
+        EcsSizeT    firstComponent;         // Index of the first component record
+        EcsSizeT    componentsNum;
+    };
+
+    struct EcsSnapshotComponent
+    {
+        uint64_t    typeHash;
+        EcsSizeT    sizeBytes;
+        EcsSizeT    storage;                // EcsComponentStorage
+        EcsSizeT    offset;                 // Column offset in chunk or offset of the shared value
+    };
 
-        ArrayContainer<EcsEntity, EngineConfig::ECS_MAX_ENTITIES>       entities;
-        ArrayContainer<EcsArchetype, EngineConfig::ECS_MAX_ARCHETYPES>  archetypes;
+    struct EcsSnapshotSparseSet
+    {
+        uint64_t    typeHash;
+        EcsSizeT    sizeBytes;
+        EcsSizeT    size;
+        EcsSizeT    handlesOffset;
+        EcsSizeT    componentsOffset;
+    };
+
+    struct EcsSnapshotSingleton
+    {
+        uint64_t    typeHash;
+        EcsSizeT    sizeBytes;
+        EcsSizeT    dataOffset;
     };
 
     // =================================================================================================================================
@@ -77,39 +465,259 @@ namespace al::engine
     void destruct(EcsWorld* world);
 
                                 EcsEntityHandle ecs_create_entity       (EcsWorld* world);
+                                void            ecs_create_entities     (EcsWorld* world, EcsArchetypeHandle archetype, std::span<EcsEntityHandle> handles);
+                                void            ecs_destroy_entity      (EcsWorld* world, EcsEntityHandle handle);
+                                void            ecs_destroy_entities    (EcsWorld* world, std::span<const EcsEntityHandle> handles);
+                                bool            ecs_is_entity_alive     (EcsWorld* world, EcsEntityHandle handle);
+    template<typename ... T>    void            ecs_create_entities     (EcsWorld* world, std::span<EcsEntityHandle> handles);
     template<typename ... T>    void            ecs_add_components      (EcsWorld* world, EcsEntityHandle handle);
     template<typename ... T>    void            ecs_remove_components   (EcsWorld* world, EcsEntityHandle handle);
+    template<typename ... T>    void            ecs_add_components      (EcsWorld* world, std::span<const EcsEntityHandle> handles);
+    template<typename ... T>    void            ecs_remove_components   (EcsWorld* world, std::span<const EcsEntityHandle> handles);
     template<typename T>        T*              ecs_get_component       (EcsWorld* world, EcsEntityHandle handle);
 
     // // @NOTE :  This version of for_each is faster than the one below
     template<typename ... T>    void            ecs_for_each_fp         (EcsWorld* world, EcsForEachFunctionPointer<T...> func);
     template<typename ... T>    void            ecs_for_each            (EcsWorld* world, EcsForEachFunctionObject<T...> func);
 
+    // @NOTE :  Each archetype chunk is processed by a separate job. Calling thread dispatches jobs
+    //          from the job system queue until all chunks are processed. func is called concurrently,
+    //          so it must not add or remove components or create entities.
+    template<typename ... T>    void            ecs_for_each_parallel   (EcsWorld* world, JobSystem* jobSystem, EcsForEachFunctionObject<T...> func);
+
+    // @NOTE :  Query must be destructed before the world. F... are query filters (EcsWith, EcsWithout, EcsAnyOf).
+    //          Function of query iteration takes query components without EcsOptional wrapper.
+    template<typename ... F, typename ... T>    void    construct               (EcsQuery<T...>* query, EcsWorld* world);
+    template<typename ... T>    void            destruct                (EcsQuery<T...>* query, EcsWorld* world);
+    template<typename ... T>    void            ecs_for_each_fp         (EcsWorld* world, EcsQuery<T...>* query, EcsForEachFunctionPointer<EcsQueryTermType<T>...> func);
+    template<typename ... T>    void            ecs_for_each            (EcsWorld* world, EcsQuery<T...>* query, EcsForEachFunctionObject<EcsQueryTermType<T>...> func);
+
+    // @NOTE :  Chunk versions of for_each. func is called once per archetype chunk with entity handles and
+    //          component arrays of this chunk, so inner loop goes over contiguous memory and can be vectorized.
+    template<typename ... T>    void            ecs_for_each_chunk_fp   (EcsWorld* world, EcsForEachChunkFunctionPointer<T...> func);
+    template<typename ... T>    void            ecs_for_each_chunk      (EcsWorld* world, EcsForEachChunkFunctionObject<T...> func);
+    template<typename ... T>    void            ecs_for_each_chunk_fp   (EcsWorld* world, EcsQuery<T...>* query, EcsForEachChunkFunctionPointer<EcsQueryTermType<T>...> func);
+    template<typename ... T>    void            ecs_for_each_chunk      (EcsWorld* world, EcsQuery<T...>* query, EcsForEachChunkFunctionObject<EcsQueryTermType<T>...> func);
+
+    // @NOTE :  Change versions. Iteration and ecs_get_component mark chunk columns of non-const components as
+    //          changed, so read-only systems should request const components (e.g. ecs_for_each<const Position>).
+    //          Structural changes mark all columns of the affected chunks. After ecs_set_changed_filter<U...> query
+    //          skips chunks in which none of U... components were changed since previous iteration of this query.
+    //          U... must be query components. Changes made by the query itself are not visible to it.
+    template<typename ... U, typename ... T> void       ecs_set_changed_filter  (EcsQuery<T...>* query);
+
+    // @NOTE :  World singletons. Singleton is a single component value which is not attached to any entity.
+    //          ecs_get_singleton returns nullptr if singleton was not set. Tags can't be singletons.
+    template<typename T>        T*              ecs_get_singleton       (EcsWorld* world);
+    template<typename T>        T*              ecs_set_singleton       (EcsWorld* world, const T& value);
+    template<typename T>        void            ecs_remove_singleton    (EcsWorld* world);
+
+    // @NOTE :  Command buffer versions of structural changes. Handles returned by ecs_create_entity are
+    //          valid only for commands of the same buffer until it is executed.
+                                void            construct               (EcsCommandBuffer* buffer);
+                                void            destruct                (EcsCommandBuffer* buffer);
+                                EcsEntityHandle ecs_create_entity       (EcsCommandBuffer* buffer);
+                                void            ecs_destroy_entity      (EcsCommandBuffer* buffer, EcsEntityHandle handle);
+    template<typename ... T>    void            ecs_add_components      (EcsCommandBuffer* buffer, EcsEntityHandle handle);
+    template<typename ... T>    void            ecs_remove_components   (EcsCommandBuffer* buffer, EcsEntityHandle handle);
+    template<typename T>        void            ecs_set_component       (EcsCommandBuffer* buffer, EcsEntityHandle handle, const T& value);
+
+    // @NOTE :  Commands are applied in the following order : entity creation, add and remove components,
+    //          set components, entity destruction. Add and remove commands for each entity are merged
+    //          and entities are moved sorted by destination archetype, so each pair of archetypes
+    //          is processed by a single ecs_move_entities call. Buffers are cleared after execution.
+                                void            ecs_execute_command_buffers(EcsWorld* world, std::span<EcsCommandBuffer*> buffers);
+
+    // @NOTE :  World snapshots store entity table, archetype chunks, sparse sets and singletons (queries are not stored).
+    //          ecs_load_snapshot maps the file and uses stored entity pages and chunks in place. Entity table is validated
+    //          with a single linear pass before loading, but chunks are never read, so loading time depends on the number
+    //          of entities, archetypes and sparse components, not on the size of components. Mapping is private : written pages
+    //          are copied, file is not changed. Components are matched by type hashes, so they must be registered
+    //          before loading. Archetypes whose chunk layout differs from the stored one are copied entity by entity.
+    //          Snapshot can be loaded only into a newly constructed world. Both functions return false on file errors.
+                                bool            ecs_save_snapshot       (EcsWorld* world, const char* path);
+                                bool            ecs_load_snapshot       (EcsWorld* world, const char* path);
+
+    // @NOTE :  Copy-on-write snapshot of the world. Snapshot shares entity pages and archetype chunks with the world,
+    //          so it is created without touching entities. Shared page or chunk is copied by the world (or by the snapshot)
+    //          on the first write to it, so world and snapshot can be used from different threads (each one from a single thread).
+    //          Sparse set position pages are shared the same way, while dense arrays of sparse sets and singletons are copied
+    //          with memcpy, so creation time depends on the number of archetypes, chunks, pages and sparse components.
+    //          Chunks and entity pages of a world loaded with ecs_load_snapshot point into the file mapping, they are copied
+    //          to the ecs pool when first snapshot is created, so that snapshot costs a copy of all chunks.
+    //          Snapshot must be a newly constructed world, it is released with destruct.
+                                void            ecs_create_snapshot     (EcsWorld* world, EcsWorld* snapshot);
+
+    // @NOTE :  Observers are called when T is added to or removed from entities (including creation and destruction
+    //          of entities) and when T is set by a command buffer. Events are not delivered right away : they are
+    //          collected during structural changes and ecs_flush_observers calls each observer once per component
+    //          and event type with handles of all changed entities. ecs_execute_command_buffers flushes observers
+    //          after all commands are applied, events of immediate changes are delivered by the next explicit flush
+    //          (application flushes default world once per frame). Handles of removed components might belong to
+    //          destroyed entities, and entity might be already changed again, so observers should check the current state of the entity.
+    //          Observers can make structural changes, resulting events are delivered by the same flush.
+    template<typename T>        void            ecs_add_observer        (EcsWorld* world, EcsObserverEvent event, EcsObserverFunctionPointer func, void* userData = nullptr);
+    template<typename T>        void            ecs_remove_observer     (EcsWorld* world, EcsObserverEvent event, EcsObserverFunctionPointer func, void* userData = nullptr);
+                                void            ecs_flush_observers     (EcsWorld* world);
+
     // =================================================================================================================================
     // INNER STUFF
     // =================================================================================================================================
 
+    EcsEntity*          ecs_get_entity                  (EcsWorld* world, EcsEntityHandle handle);
+    EcsEntity*          ecs_get_entity_by_index         (EcsWorld* world, EcsSizeT index);
+    EcsArchetype*       ecs_get_archetype               (EcsWorld* world, EcsArchetypeHandle handle);
+    bool                ecs_is_snapshot_memory          (EcsWorld* world, const void* memory);
+    void                ecs_copy_snapshot_memory        (EcsWorld* world);
+    std::atomic<uint32_t>* ecs_get_block_references     (const void* block);
+    void                ecs_release_block               (void* block);
+    std::byte*          ecs_get_writable_block          (EcsWorld* world, std::byte* block);
+    uint8_t*            ecs_get_writable_chunk          (EcsWorld* world, EcsArchetype* archetype, EcsSizeT chunkIndex);
+    EcsEntity*          ecs_get_writable_entity         (EcsWorld* world, EcsEntityHandle handle);
+    EcsEntity*          ecs_get_writable_entity_by_index(EcsWorld* world, EcsSizeT index);
+    bool                ecs_snapshot_write              (std::FILE* file, EcsSizeT* fileOffset, const void* data, EcsSizeT size);
+    bool                ecs_snapshot_pad                (std::FILE* file, EcsSizeT* fileOffset, EcsSizeT targetOffset);
+    bool                ecs_validate_snapshot           (const std::byte* file, EcsSizeT fileSize);
+    EcsArchetypeHandle  ecs_load_snapshot_archetype     (EcsWorld* world, const EcsSnapshotArchetype* record);
+    void                ecs_release_entity              (EcsWorld* world, EcsEntityHandle handle);
+    void                ecs_add_observer                (EcsWorld* world, EcsComponentId componentId, EcsObserverEvent event, EcsObserverFunctionPointer func, void* userData);
+    void                ecs_remove_observer             (EcsWorld* world, EcsComponentId componentId, EcsObserverEvent event, EcsObserverFunctionPointer func, void* userData);
+    void                ecs_record_observer_event       (EcsWorld* world, EcsObserverEvent event, EcsComponentId componentId, EcsEntityHandle handle);
+    void                ecs_record_observer_events      (EcsWorld* world, EcsObserverEvent event, EcsComponentFlags flags, std::span<const EcsEntityHandle> handles);
     EcsArchetypeHandle  ecs_match_or_create_archetype   (EcsWorld* world, EcsEntityHandle handle);
     EcsArchetypeHandle  ecs_create_archetype            (EcsWorld* world, EcsComponentFlags flags);
+    EcsArchetypeHandle  ecs_find_archetype              (EcsWorld* world, EcsComponentFlags flags);
+    EcsArchetypeHandle  ecs_find_or_create_archetype    (EcsWorld* world, EcsComponentFlags flags);
+    void                ecs_add_archetype_to_lookup     (EcsWorld* world, EcsArchetypeHandle handle);
+    void                ecs_grow_archetype_lookup       (EcsWorld* world);
+    void                ecs_clear_archetype_edges       (EcsWorld* world, EcsArchetypeHandle handle);
+    EcsArchetypeHandle  ecs_get_add_edge                (EcsWorld* world, EcsArchetypeHandle handle, EcsComponentId componentId);
+    EcsArchetypeHandle  ecs_get_remove_edge             (EcsWorld* world, EcsArchetypeHandle handle, EcsComponentId componentId);
+    EcsSizeT            ecs_hash_component_flags        (EcsComponentFlags flags);
+    EcsSizeT            ecs_compute_chunk_layout        (EcsComponentFlags flags, EcsSizeT capacity, EcsSizeT* componentArrayOffsets);
     void                ecs_allocate_chunks             (EcsWorld* world, EcsArchetypeHandle handle);
     void                ecs_move_entity_superset        (EcsWorld* world, EcsArchetypeHandle from, EcsArchetypeHandle to, EcsEntityHandle handle);
     void                ecs_move_entity_subset          (EcsWorld* world, EcsArchetypeHandle from, EcsArchetypeHandle to, EcsEntityHandle handle);
+    void                ecs_move_entities               (EcsWorld* world, EcsArchetypeHandle from, EcsArchetypeHandle to, std::span<const EcsEntityHandle> handles);
     EcsSizeT            ecs_reserve_position            (EcsWorld* world, EcsArchetypeHandle handle);
+    EcsSizeT            ecs_reserve_positions           (EcsWorld* world, EcsArchetypeHandle handle, EcsSizeT count);
+    void                ecs_zero_components             (EcsWorld* world, EcsArchetypeHandle handle, EcsComponentFlags flags, EcsSizeT index, EcsSizeT count);
     void                ecs_free_position               (EcsWorld* world, EcsArchetypeHandle handle, EcsSizeT index);
+    void                ecs_free_positions              (EcsWorld* world, EcsArchetypeHandle handle, std::span<EcsSizeT> indices);
+    void                ecs_copy_components             (EcsWorld* world, EcsArchetypeHandle handle, EcsSizeT from, EcsSizeT to);
     uint8_t*            ecs_access_component           (EcsWorld* world, EcsArchetypeHandle handle, EcsComponentId componentId, EcsSizeT index);
 
     template<typename T>
     T* ecs_access_component(EcsArchetype* archetype, EcsSizeT index);
 
+    template<typename T>
+    T* ecs_access_chunk_component_array(EcsArchetype* archetype, EcsSizeT chunkIndex);
+
+    // @NOTE :  Column of shared component points to the single archetype value, so rows of shared
+    //          component are not advanced and chunk spans of shared component have size one
+    template<typename T>
+    T* ecs_access_column(EcsArchetype* archetype, uint8_t* chunk, EcsSizeT columnOffset);
+
+    template<typename T>
+    T* ecs_access_row(T* column, EcsSizeT index);
+
+    template<typename T>
+    std::span<T> ecs_make_column_span(T* column, EcsSizeT entitiesNum);
+
+    EcsSparseSet*   ecs_get_sparse_set              (EcsWorld* world, EcsComponentId componentId);
+    EcsSparseSet*   ecs_get_or_create_sparse_set    (EcsWorld* world, EcsComponentId componentId);
+    void            ecs_fill_sparse_set             (EcsSparseSet* set, const EcsEntityHandle* handles, const uint8_t* components, EcsSizeT size);
+    uint32_t*       ecs_access_sparse_position      (EcsWorld* world, EcsSparseSet* set, uint32_t entityIndex, bool isWrite);
+    uint8_t*        ecs_sparse_get                  (EcsWorld* world, EcsComponentId componentId, EcsEntityHandle handle);
+    uint8_t*        ecs_sparse_insert               (EcsWorld* world, EcsComponentId componentId, EcsEntityHandle handle);
+    void            ecs_sparse_remove               (EcsWorld* world, EcsComponentId componentId, EcsEntityHandle handle);
+    void            ecs_sparse_remove_entity        (EcsWorld* world, EcsEntityHandle handle);
+    void            ecs_sparse_apply_flags          (EcsWorld* world, EcsEntityHandle handle, EcsComponentFlags flags, bool isAdd);
+
+    template<typename ... T> void ecs_add_sparse_components     (EcsWorld* world, EcsEntityHandle handle);
+    template<typename ... T> void ecs_remove_sparse_components  (EcsWorld* world, EcsEntityHandle handle);
+
+    template<typename T>
+    T* ecs_access_entity_component(EcsWorld* world, EcsEntity* entity, EcsEntityHandle handle);
+
+    template<typename ... T, typename Func>
+    void ecs_for_each_sparse(EcsWorld* world, const EcsArchetypeFilter* filter, Func* func);
+
+    void ecs_allocate_shared_components (EcsArchetype* archetype);
+    void ecs_copy_shared_components     (EcsWorld* world, EcsArchetypeHandle from, EcsArchetypeHandle to);
+
+    template<typename ... T, typename Func>
+    void ecs_for_each_in_chunk(EcsWorld* world, EcsArchetype* archetype, EcsSizeT chunkIndex, Func* func);
+
+    EcsSizeT ecs_get_chunk_entities_num(EcsArchetype* archetype, EcsSizeT chunkIndex);
+
+    EcsEntityHandle* ecs_access_entity_handle(EcsArchetype* archetype, EcsSizeT index);
+    EcsEntityHandle* ecs_access_chunk_entity_handles(EcsArchetype* archetype, EcsSizeT chunkIndex);
+
+    EcsSizeT*   ecs_get_chunk_versions          (EcsArchetype* archetype, EcsSizeT chunkIndex);
+    EcsSizeT    ecs_get_component_index         (EcsArchetype* archetype, EcsComponentId componentId);
+    void        ecs_mark_chunk_changed          (EcsWorld* world, EcsArchetype* archetype, EcsSizeT chunkIndex);
+    void        ecs_mark_chunks_changed         (EcsWorld* world, EcsArchetype* archetype, EcsSizeT index, EcsSizeT count);
+    void        ecs_mark_component_changed      (EcsWorld* world, EcsArchetype* archetype, EcsSizeT chunkIndex, EcsComponentId componentId);
+    bool        ecs_is_chunk_changed            (const EcsQueryState* state, const EcsSizeT* chunkVersions, const EcsSizeT* versionIndices);
+    void        ecs_finish_query_iteration      (EcsWorld* world, EcsQueryState* state);
+
+    template<typename T>
+    void ecs_mark_component_changed(EcsWorld* world, EcsArchetype* archetype, EcsSizeT chunkIndex);
+
+    template<typename ... T, std::size_t ... Indices>
+    void ecs_mark_components_changed(EcsWorld* world, EcsSizeT* chunkVersions, const EcsSizeT* versionIndices, std::index_sequence<Indices...>);
+
+    void ecs_dispatch_jobs_until(JobSystem* jobSystem, std::atomic<EcsSizeT>* finishedJobsNum, EcsSizeT targetJobsNum);
+
+    void ecs_push_command           (EcsCommandBuffer* buffer, EcsCommandType type, EcsEntityHandle handle, EcsComponentFlags flags = { }, EcsComponentFlags sparseFlags = { });
+    void ecs_push_command_data      (EcsCommandBuffer* buffer, const void* data, EcsSizeT sizeBytes);
+    void ecs_clear                  (EcsCommandBuffer* buffer);
+
+    void ecs_register_query         (EcsWorld* world, EcsQueryState* state);
+    void ecs_unregister_query       (EcsWorld* world, EcsQueryState* state);
+    void ecs_query_try_add_archetype(EcsWorld* world, EcsQueryState* state, EcsArchetypeHandle handle);
+    void ecs_query_add_archetype    (EcsWorld* world, EcsQueryState* state, EcsArchetypeHandle handle);
+
+    bool ecs_is_matching_archetype      (const EcsArchetypeFilter* filter, EcsComponentFlags flags);
+    void ecs_find_matching_archetypes   (EcsWorld* world, const EcsArchetypeFilter* filter, DynamicArray<EcsArchetypeHandle>* result);
+
+    template<typename ... T> void ecs_apply_query_filter(EcsQueryState* state, EcsWith<T...>);
+    template<typename ... T> void ecs_apply_query_filter(EcsQueryState* state, EcsWithout<T...>);
+    template<typename ... T> void ecs_apply_query_filter(EcsQueryState* state, EcsAnyOf<T...>);
+
+    template<typename T> EcsQueryTermType<T>*               ecs_access_query_column     (EcsArchetype* archetype, uint8_t* chunk, EcsSizeT columnOffset);
+    template<typename T> EcsQueryTermType<T>*               ecs_access_query_row        (EcsQueryTermType<T>* column, EcsSizeT index);
+    template<typename T> std::span<EcsQueryTermType<T>>     ecs_make_query_column_span  (EcsQueryTermType<T>* column, EcsSizeT entitiesNum);
+
+    template<typename ... T, typename Func, std::size_t ... Indices>
+    void ecs_for_each_in_query_archetype(EcsWorld* world, EcsQueryState* state, EcsQueryArchetype* queryArchetype, Func* func, std::index_sequence<Indices...>);
+
+    template<typename ... T, typename Func, std::size_t ... Indices>
+    void ecs_for_each_chunk_in_archetype(EcsWorld* world, EcsArchetype* archetype, const EcsSizeT* columnOffsets, const EcsSizeT* versionIndices, const EcsQueryState* state, Func* func, std::index_sequence<Indices...>);
+
+    template<typename ... T, typename Func>
+    void ecs_for_each_chunk_matching(EcsWorld* world, Func* func);
+
+    template<typename ... T, typename Func>
+    void ecs_for_each_chunk_in_query(EcsWorld* world, EcsQuery<T...>* query, Func* func);
+
     template<typename T>                    EcsComponentId  ecs_component_type_info_get_id      ();
     template<typename T>                    EcsSizeT        ecs_component_type_info_get_size    ();
+    template<typename T>                    EcsSizeT        ecs_component_type_info_get_alignment();
     template<typename T>                    bool            ecs_is_component_registered         ();
     template<typename T, typename ... U>    bool            ecs_is_components_registered        (bool value = true);
     template<typename T>                    void            ecs_register_component              ();
     template<typename T, typename ... U>    void            ecs_register_components_if_needed   ();
     template<typename T, typename ... U>    void            ecs_set_component_flags             (EcsComponentFlags* flags);
     template<typename T, typename ... U>    void            ecs_clear_component_flags           (EcsComponentFlags* flags);
+    template<typename T, typename ... U>    void            ecs_set_sparse_component_flags      (EcsComponentFlags* flags);
+    template<typename T, typename ... U>    EcsArchetypeHandle ecs_follow_add_edges             (EcsWorld* world, EcsArchetypeHandle handle);
+    template<typename T, typename ... U>    EcsArchetypeHandle ecs_follow_remove_edges          (EcsWorld* world, EcsArchetypeHandle handle);
+    template<typename Func>                 void            ecs_for_each_archetype_run          (EcsWorld* world, std::span<const EcsEntityHandle> handles, Func func);
                                             bool            ecs_is_valid_subset                 (EcsComponentFlags subset, EcsComponentFlags superset);
+                                            EcsComponentId  ecs_acquire_component_id            (uint64_t typeHash, EcsSizeT sizeBytes, EcsSizeT alignment, EcsComponentStorage storage);
+                                            EcsComponentId  ecs_find_component_id               (uint64_t typeHash);
 }
 
 #endif
@@ -0,0 +1,163 @@
+#ifndef AL_ECS_BENCHMARKS_H
+#define AL_ECS_BENCHMARKS_H
+
+#include <cstddef>
+#include <cmath>        // for std::sqrt
+#include <chrono>
+#include <iostream>
+
+#include "ecs.h"
+#include "engine/config/engine_config.h"
+#include "engine/memory/memory_manager.h"
+#include "engine/job_system/job_system.h"
+
+#include "utilities/constexpr_functions.h"
+
+// @NOTE :  ECS iteration benchmarks. Each entity has position and velocity components,
+//          per-entity update integrates velocity and normalizes it. Same update is run
+//          with ecs_for_each_fp, ecs_for_each, cached EcsQuery (per entity and per chunk)
+//          and ecs_for_each_parallel (for each number of worker threads).
+//          Results are written to the given stream as JSON.
+//          Entities are spread over several archetypes, so the benchmark also touches
+//          archetype matching. Number of entities is clamped to the ecs pool capacity
+//          (see ecs_benchmark_max_entities), both numbers are reported.
+
+namespace al::engine::test
+{
+    using EcsBenchmarkClock = std::chrono::steady_clock;
+    using EcsBenchmarkTime  = EcsBenchmarkClock::time_point;
+
+    struct EcsBenchmarkPosition { float x; float y; float z; };
+    struct EcsBenchmarkVelocity { float x; float y; float z; };
+    template<std::size_t Index> struct EcsBenchmarkGroup { uint8_t value; };
+
+    static constexpr std::size_t    ECS_BENCHMARK_GROUPS_NUM            = 4;
+    static constexpr std::size_t    ECS_BENCHMARK_MIN_ENTITY_UPDATES    = 20000000;
+    static constexpr float          ECS_BENCHMARK_DT                    = 1.0f / 60.0f;
+
+    struct EcsBenchmarkResult
+    {
+        std::size_t entityUpdatesNum;
+        double      seconds;
+    };
+
+    inline std::size_t ecs_benchmark_max_entities()
+    {
+        // @NOTE :  Entity table and archetype chunks are allocated from the ecs pool. Half of the pool
+        //          is left for chunk padding and partially filled pages.
+        constexpr std::size_t ENTITY_SIZE = sizeof(EcsEntity) + sizeof(EcsEntityHandle) + sizeof(EcsBenchmarkPosition) + sizeof(EcsBenchmarkVelocity) + sizeof(EcsBenchmarkGroup<0>);
+        return EngineConfig::ECS_POOL_ALLOCATOR_MEMORY_SIZE / (ENTITY_SIZE * 2);
+    }
+
+    inline void ecs_benchmark_update(EcsWorld*, EcsEntityHandle, EcsBenchmarkPosition* position, EcsBenchmarkVelocity* velocity)
+    {
+        position->x += velocity->x * ECS_BENCHMARK_DT;
+        position->y += velocity->y * ECS_BENCHMARK_DT;
+        position->z += velocity->z * ECS_BENCHMARK_DT;
+        const float length = std::sqrt(velocity->x * velocity->x + velocity->y * velocity->y + velocity->z * velocity->z) + 1.0f;
+        velocity->x = velocity->x / length + position->y * 0.001f;
+        velocity->y = velocity->y / length + position->z * 0.001f;
+        velocity->z = velocity->z / length + position->x * 0.001f;
+    }
+
+    inline void ecs_benchmark_update_chunk(EcsWorld* world, std::span<EcsEntityHandle> handles, std::span<EcsBenchmarkPosition> positions, std::span<EcsBenchmarkVelocity> velocities)
+    {
+        for (std::size_t it = 0; it < handles.size(); it++)
+        {
+            ecs_benchmark_update(world, handles[it], &positions[it], &velocities[it]);
+        }
+    }
+
+    void ecs_benchmark_fill_world(EcsWorld* world, std::size_t entitiesNum)
+    {
+        for (std::size_t it = 0; it < entitiesNum; it++)
+        {
+            EcsEntityHandle handle = ecs_create_entity(world);
+            switch (it % ECS_BENCHMARK_GROUPS_NUM)
+            {
+                case 0: ecs_add_components<EcsBenchmarkPosition, EcsBenchmarkVelocity, EcsBenchmarkGroup<0>>(world, handle); break;
+                case 1: ecs_add_components<EcsBenchmarkPosition, EcsBenchmarkVelocity, EcsBenchmarkGroup<1>>(world, handle); break;
+                case 2: ecs_add_components<EcsBenchmarkPosition, EcsBenchmarkVelocity, EcsBenchmarkGroup<2>>(world, handle); break;
+                case 3: ecs_add_components<EcsBenchmarkPosition, EcsBenchmarkVelocity, EcsBenchmarkGroup<3>>(world, handle); break;
+            }
+            const float value = static_cast<float>(it % 1000);
+            *ecs_get_component<EcsBenchmarkPosition>(world, handle) = { value, value * 0.5f, value * 0.25f };
+            *ecs_get_component<EcsBenchmarkVelocity>(world, handle) = { 1.0f, 2.0f, 3.0f };
+        }
+    }
+
+    template<typename Func>
+    EcsBenchmarkResult ecs_benchmark_run(std::size_t entitiesNum, Func func)
+    {
+        const std::size_t iterationsNum = maximum(ECS_BENCHMARK_MIN_ENTITY_UPDATES / entitiesNum, std::size_t{ 1 });
+        const EcsBenchmarkTime begin = EcsBenchmarkClock::now();
+        for (std::size_t it = 0; it < iterationsNum; it++)
+        {
+            func();
+        }
+        return { iterationsNum * entitiesNum, std::chrono::duration<double>(EcsBenchmarkClock::now() - begin).count() };
+    }
+
+    void write_ecs_benchmark_result(std::ostream& stream, const char* name, std::size_t requestedEntitiesNum, std::size_t entitiesNum, std::size_t threadsNum, EcsBenchmarkResult result, bool isLast)
+    {
+        stream << "    { \"benchmark\": \"" << name << "\", \"requested_entities\": " << requestedEntitiesNum
+               << ", \"entities\": " << entitiesNum
+               << ", \"threads\": " << threadsNum
+               << ", \"entity_updates\": " << result.entityUpdatesNum
+               << ", \"seconds\": " << result.seconds
+               << ", \"entity_updates_per_second\": " << (result.seconds > 0.0 ? static_cast<double>(result.entityUpdatesNum) / result.seconds : 0.0)
+               << " }" << (isLast ? "" : ",") << std::endl;
+    }
+
+    void run_ecs_benchmarks(std::ostream& stream, std::size_t maxThreadsNum)
+    {
+        const std::size_t requestedEntitiesNums[] = { 100000, 250000, 500000, 1000000, 2000000 };
+        stream << "{" << std::endl;
+        stream << "  \"chunk_size_bytes\": " << EngineConfig::ECS_COMPONENT_ARRAY_CHUNK_SIZE << "," << std::endl;
+        stream << "  \"results\": [" << std::endl;
+        for (std::size_t requestIt = 0; requestIt < sizeof(requestedEntitiesNums) / sizeof(requestedEntitiesNums[0]); requestIt++)
+        {
+            const std::size_t requestedEntitiesNum = requestedEntitiesNums[requestIt];
+            const std::size_t entitiesNum = minimum(requestedEntitiesNum, ecs_benchmark_max_entities());
+            const bool isLastRequest = requestIt == sizeof(requestedEntitiesNums) / sizeof(requestedEntitiesNums[0]) - 1;
+            EcsWorld* world = MemoryManager::get_stack()->allocate_as<EcsWorld>();
+            construct(world);
+            ecs_benchmark_fill_world(world, entitiesNum);
+            write_ecs_benchmark_result(stream, "for_each_fp", requestedEntitiesNum, entitiesNum, 1, ecs_benchmark_run(entitiesNum, [world]()
+            {
+                ecs_for_each_fp<EcsBenchmarkPosition, EcsBenchmarkVelocity>(world, ecs_benchmark_update);
+            }), false);
+            write_ecs_benchmark_result(stream, "for_each", requestedEntitiesNum, entitiesNum, 1, ecs_benchmark_run(entitiesNum, [world]()
+            {
+                ecs_for_each<EcsBenchmarkPosition, EcsBenchmarkVelocity>(world, EcsForEachFunctionObject<EcsBenchmarkPosition, EcsBenchmarkVelocity>{ ecs_benchmark_update });
+            }), false);
+            EcsQuery<EcsBenchmarkPosition, EcsBenchmarkVelocity> query;
+            construct(&query, world);
+            write_ecs_benchmark_result(stream, "for_each_query", requestedEntitiesNum, entitiesNum, 1, ecs_benchmark_run(entitiesNum, [world, &query]()
+            {
+                ecs_for_each(world, &query, EcsForEachFunctionObject<EcsBenchmarkPosition, EcsBenchmarkVelocity>{ ecs_benchmark_update });
+            }), false);
+            write_ecs_benchmark_result(stream, "for_each_chunk_query", requestedEntitiesNum, entitiesNum, 1, ecs_benchmark_run(entitiesNum, [world, &query]()
+            {
+                ecs_for_each_chunk_fp(world, &query, ecs_benchmark_update_chunk);
+            }), false);
+            destruct(&query, world);
+            for (std::size_t threadsNum = 1; threadsNum <= maxThreadsNum; threadsNum++)
+            {
+                // @NOTE :  Calling thread also dispatches chunk jobs, so it is counted as a worker
+                JobSystem* jobSystem = MemoryManager::get_stack()->allocate_as<JobSystem>();
+                construct(jobSystem, threadsNum - 1);
+                write_ecs_benchmark_result(stream, "for_each_parallel", requestedEntitiesNum, entitiesNum, threadsNum, ecs_benchmark_run(entitiesNum, [world, jobSystem]()
+                {
+                    ecs_for_each_parallel<EcsBenchmarkPosition, EcsBenchmarkVelocity>(world, jobSystem, EcsForEachFunctionObject<EcsBenchmarkPosition, EcsBenchmarkVelocity>{ ecs_benchmark_update });
+                }), isLastRequest && threadsNum == maxThreadsNum);
+                destruct(jobSystem);
+            }
+            destruct(world);
+        }
+        stream << "  ]" << std::endl;
+        stream << "}" << std::endl;
+    }
+}
+
+#endif
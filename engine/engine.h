@@ -39,6 +39,7 @@
 #include "engine/game_cameras/fly_camera.h"
 #include "engine/job_system/job_system_job.h"
 #include "engine/job_system/job_system_thread.h"
+#include "engine/job_system/job_system_timer_wheel.h"
 #include "engine/job_system/job_system.h"
 #include "engine/memory/memory_common.h"
 #include "engine/memory/allocator_base.h"
@@ -65,6 +66,7 @@
 #include "engine/platform/platform_thread_event.h"
 #include "engine/platform/platform_thread_utilities.h"
 #include "engine/platform/platform_file_system_utilities.h"
+#include "engine/platform/platform_file_mapping.h"
 #include "engine/ecs/ecs.h"
 #include "engine/scene/scene_transform.h"
 #include "engine/scene/scene.h"
@@ -81,6 +83,8 @@
 #   include "engine/platform/win32/opengl/win32_opengl_shader.h"
 #   include "engine/platform/win32/opengl/win32_opengl_framebuffer.h"
 #   include "engine/platform/win32/opengl/win32_opengl_renderer.h"
+#elif defined(__linux__)
+    // @TODO :  Only thread utilities are implemented for Linux currently
 #else
 #   error Unsupported platform
 #endif
@@ -94,6 +98,7 @@
 #include "engine/game_cameras/fly_camera.cpp"
 #include "engine/job_system/job_system_job.cpp"
 #include "engine/job_system/job_system_thread.cpp"
+#include "engine/job_system/job_system_timer_wheel.cpp"
 #include "engine/job_system/job_system.cpp"
 #include "engine/memory/memory_common.cpp"
 #include "engine/memory/dl_allocator.cpp"
@@ -128,6 +133,10 @@
 #   include "engine/platform/win32/opengl/win32_opengl_framebuffer.cpp"
 #   include "engine/platform/win32/opengl/win32_opengl_renderer.cpp"
 #   include "engine/platform/win32/platform_thread_utilities_win32.cpp"
+#   include "engine/platform/win32/platform_file_mapping_win32.cpp"
+#elif defined(__linux__)
+#   include "engine/platform/linux/platform_thread_utilities_linux.cpp"
+#   include "engine/platform/linux/platform_file_mapping_linux.cpp"
 #else
 #   error Unsupported platform
 #endif
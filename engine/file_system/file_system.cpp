@@ -27,7 +27,11 @@ namespace al::engine
         return handle;
     }
 
-    [[nodiscard]] HandleJobPair file_async_load(FileSystem* fileSystem, const StaticString& file, FileLoadMode mode)
+    // @NOTE :  File is read by gIoJobSystem threads. If continuation job is provided, it is started after
+    //          the file is loaded and receives FileHandle* as it's payload (so continuation must not have
+    //          it's own payload). Continuation is dispatched by it's own job system (usually gMainJobSystem),
+    //          so processing of the loaded data never happens on I/O threads.
+    [[nodiscard]] HandleJobPair file_async_load(FileSystem* fileSystem, const StaticString& file, FileLoadMode mode, Job* continuation)
     {
         al_profile_function();
         al_log_message( EngineConfig::FILE_SYSTEM_LOG_CATEGORY,
@@ -35,20 +39,28 @@ namespace al::engine
                         cstr(&file), LOAD_MODE_TO_STR[static_cast<int>(mode)]);
         FileHandle* handle = fileSystem->allocator->allocate_and_construct<FileHandle>();
         handle->state = FileHandle::State::LOADING;
-        AsyncFileReadUserData* userData = fileSystem->allocator->allocate_and_construct<AsyncFileReadUserData>();
-        construct(&userData->file, &file);
-        userData->mode = mode;
-        userData->handle = handle;
-        Job* job = get_job(gMainJobSystem);
+        Job* job = get_job(gIoJobSystem);
         configure(job, [fileSystem](Job* job)
         {
-            AsyncFileReadUserData* userData = reinterpret_cast<AsyncFileReadUserData*>(job->userData);
+            AsyncFileReadUserData* userData = get_payload<AsyncFileReadUserData>(job);
             al_log_message( EngineConfig::FILE_SYSTEM_LOG_CATEGORY,
                             "Processing async load of file at path %s with mode %s",
                             cstr(&userData->file), LOAD_MODE_TO_STR[static_cast<int>(userData->mode)]);
             *userData->handle = al::engine::sync_load(cstr(&userData->file), fileSystem->allocator, userData->mode);
-        }, userData);
-        start_job(gMainJobSystem, job);
+        });
+        AsyncFileReadUserData* userData = emplace_payload<AsyncFileReadUserData>(job);
+        construct(&userData->file, &file);
+        userData->mode = mode;
+        userData->handle = handle;
+        if (continuation)
+        {
+            // @NOTE :  Continuation must be linked and started before load job, otherwise
+            //          load job can finish before set_after is called
+            emplace_payload<FileHandle*>(continuation, handle);
+            set_after(continuation, job);
+            start_job(continuation->jobSystem, continuation);
+        }
+        start_job(gIoJobSystem, job);
         return { handle, job };
     }
 
@@ -59,7 +59,7 @@ namespace al::engine
     void destruct(FileSystem* fileSystem);
 
     [[nodiscard]] FileHandle*   file_sync_load  (FileSystem* fileSystem, const StaticString& file, FileLoadMode mode);
-    [[nodiscard]] HandleJobPair file_async_load (FileSystem* fileSystem, const StaticString& file, FileLoadMode mode);
+    [[nodiscard]] HandleJobPair file_async_load (FileSystem* fileSystem, const StaticString& file, FileLoadMode mode, Job* continuation = nullptr);
     void                        file_free_handle(FileSystem* fileSystem, FileHandle* handle);
 }
 
@@ -6,15 +6,43 @@
 #include "engine/debug/debug.h"
 
 #include "utilities/procedural_wrap.h"
+#include "utilities/constexpr_functions.h"
 
 namespace al::engine
 {
+    namespace job_system_private
+    {
+        uint64_t get_current_timer_tick(JobSystem* jobSystem)
+        {
+            return (std::chrono::steady_clock::now() - jobSystem->timersStartTime) / EngineConfig::JOB_TIMER_WHEEL_TICK;
+        }
+
+        uint64_t to_timer_ticks(std::chrono::nanoseconds duration)
+        {
+            // Rounded up, so job never starts earlier than requested
+            return (duration + EngineConfig::JOB_TIMER_WHEEL_TICK - std::chrono::nanoseconds{ 1 }) / EngineConfig::JOB_TIMER_WHEEL_TICK;
+        }
+
+        void add_job_to_timers(JobSystem* jobSystem, Job* job)
+        {
+            al_assert(job->jobSystem == jobSystem);
+            al_assert_msg(is_ready_for_dispatch(job), "Delayed job can't wait for other jobs");
+            al_assert_msg(job->nextJobs.size == 0 || job->timerPeriod == 0, "Periodic job can't have next jobs");
+            bool result = jobSystem->pendingTimers.enqueue(&job);
+            al_assert(result);
+        }
+    }
+
     JobSystem* gMainJobSystem = nullptr;
     JobSystem* gRenderJobSystem = nullptr;
+    JobSystem* gIoJobSystem = nullptr;
 
     Job                                                 gJobs[EngineConfig::MAX_JOBS] = { };
     StaticThreadSafeQueue<Job*, EngineConfig::MAX_JOBS> gFreeJobs;
 
+    JobPayloadOverflowBlock                                                         gJobPayloadOverflowBlocks[EngineConfig::JOB_PAYLOAD_OVERFLOW_BLOCKS] = { };
+    StaticThreadSafeQueue<std::byte*, EngineConfig::JOB_PAYLOAD_OVERFLOW_BLOCKS>    gFreeJobPayloadOverflowBlocks;
+
     void init_jobs()
     {
         wrap_construct(&gFreeJobs);
@@ -23,10 +51,41 @@ namespace al::engine
             Job* job = &gJobs[it];
             gFreeJobs.enqueue(&job);
         }
+        wrap_construct(&gFreeJobPayloadOverflowBlocks);
+        for (std::size_t it = 0; it < EngineConfig::JOB_PAYLOAD_OVERFLOW_BLOCKS; it++)
+        {
+            std::byte* block = gJobPayloadOverflowBlocks[it].memory;
+            gFreeJobPayloadOverflowBlocks.enqueue(&block);
+        }
+    }
+
+    std::byte* get_job_payload_overflow_block()
+    {
+        std::byte* block = nullptr;
+        gFreeJobPayloadOverflowBlocks.dequeue(&block);
+        al_assert_msg(block, "Can't get job payload overflow block : pool is empty. Consider increasing EngineConfig::JOB_PAYLOAD_OVERFLOW_BLOCKS value.");
+        return block;
     }
 
-    void construct(JobSystem* jobSystem, std::size_t numThreads)
+    void return_job_payload_overflow_block(std::byte* block)
     {
+        al_assert(block);
+        gFreeJobPayloadOverflowBlocks.enqueue(&block);
+    }
+
+    void construct(JobSystem* jobSystem, std::size_t numThreads, bool isHighPriority)
+    {
+        // @NOTE :  Queue and wake up primitives must be constructed before threads,
+        //          because threads start to use them right after creation
+        wrap_construct(&jobSystem->jobQueue);
+        wrap_construct(&jobSystem->sleepingThreadsNum, std::size_t{ 0 });
+        wrap_construct(&jobSystem->wakeSemaphore, 0);
+        wrap_construct(&jobSystem->pendingTimers);
+        wrap_construct(&jobSystem->timersLock);
+        wrap_construct(&jobSystem->frameNumber, uint64_t{ 0 });
+        jobSystem->timersStartTime = std::chrono::steady_clock::now();
+        construct(&jobSystem->timeWheel, 0);
+        construct(&jobSystem->frameWheel, 0);
         // @TODO : replace std::string_view
         // @TODO : remove wrap_construct's
         if (numThreads)
@@ -35,14 +94,13 @@ namespace al::engine
             wrap_construct(&jobSystem->threads, memory, numThreads);
             for (JobSystemThread& thread : jobSystem->threads)
             {
-                construct(&thread, jobSystem);
+                construct(&thread, jobSystem, isHighPriority);
             }
         }
         else
         {
             wrap_construct(&jobSystem->threads);
         }
-        wrap_construct(&jobSystem->jobQueue);
     }
 
     void destruct(JobSystem* jobSystem)
@@ -54,6 +112,11 @@ namespace al::engine
         // @TODO : replace std::string_view
         wrap_destruct(&jobSystem->threads);
         wrap_destruct(&jobSystem->jobQueue);
+        wrap_destruct(&jobSystem->sleepingThreadsNum);
+        wrap_destruct(&jobSystem->wakeSemaphore);
+        wrap_destruct(&jobSystem->pendingTimers);
+        wrap_destruct(&jobSystem->timersLock);
+        wrap_destruct(&jobSystem->frameNumber);
         MemoryManager::get_stack()->deallocate(reinterpret_cast<std::byte*>(jobSystem->threads.data()), sizeof(JobSystemThread) * jobSystem->threads.size());
     }
 
@@ -70,6 +133,7 @@ namespace al::engine
     {
         al_assert(job);
         al_assert(is_finished(job));
+        destroy_payload(job);
         gFreeJobs.enqueue(&job);
     }
 
@@ -83,12 +147,34 @@ namespace al::engine
         }
     }
 
+    void start_jobs(JobSystem* jobSystem, std::span<Job*> jobs)
+    {
+        // @NOTE :  Jobs which are waiting for other jobs are not added to the queue
+        //          (same as in start_job), so ready jobs are collected first and then
+        //          pushed to the queue with a single range reservation
+        al_assert_msg(jobs.size() <= EngineConfig::MAX_JOBS, "Can't start %zu jobs at once : job system has only %zu jobs", jobs.size(), EngineConfig::MAX_JOBS);
+        Job* readyJobs[EngineConfig::MAX_JOBS];
+        std::size_t readyJobsNum = 0;
+        for (Job* job : jobs)
+        {
+            al_assert(job->jobSystem == jobSystem);
+            al_assert(!is_finished(job));
+            if (is_ready_for_dispatch(job))
+            {
+                readyJobs[readyJobsNum++] = job;
+            }
+        }
+        jobSystem->jobQueue.enqueue_bulk(readyJobs, readyJobsNum);
+        wake_threads(jobSystem, readyJobsNum);
+    }
+
     void add_job_to_queue(JobSystem* jobSystem, Job* job)
     {
         al_assert(job->jobSystem == jobSystem);
         al_assert_msg(is_ready_for_dispatch(job), "add_job_to_queue only adds jobs that are ready for dispatch");
         bool result = jobSystem->jobQueue.enqueue(&job);
         al_assert(result);
+        wake_threads(jobSystem, 1);
     }
 
     Job* get_job_from_queue(JobSystem* jobSystem)
@@ -114,4 +200,147 @@ namespace al::engine
             }
         }
     }
+
+    void wait_for_jobs(JobSystem* jobSystem)
+    {
+        // @NOTE :  Semaphore wait is limited by JOB_THREAD_SLEEP_TIME, so even if wake up
+        //          was missed (job was added right before thread incremented sleepingThreadsNum)
+        //          thread will check the queue again after a short period of time.
+        //          Sleepers are claimed by wake_threads before semaphore is released, so each released
+        //          token matches exactly one sleeper. If wait timed out, but sleeper was already claimed
+        //          (counter can't be decremented), token is released right now and must be consumed here.
+        std::atomic_fetch_add_explicit(&jobSystem->sleepingThreadsNum, 1, std::memory_order_seq_cst);
+        if (jobSystem->wakeSemaphore.try_acquire_for(EngineConfig::JOB_THREAD_SLEEP_TIME))
+        {
+            return;
+        }
+        std::size_t sleepingThreadsNum = std::atomic_load_explicit(&jobSystem->sleepingThreadsNum, std::memory_order_seq_cst);
+        while (sleepingThreadsNum)
+        {
+            if (jobSystem->sleepingThreadsNum.compare_exchange_weak(sleepingThreadsNum, sleepingThreadsNum - 1, std::memory_order_seq_cst))
+            {
+                return;
+            }
+        }
+        jobSystem->wakeSemaphore.acquire();
+    }
+
+    void wake_threads(JobSystem* jobSystem, std::size_t number)
+    {
+        std::size_t sleepingThreadsNum = std::atomic_load_explicit(&jobSystem->sleepingThreadsNum, std::memory_order_seq_cst);
+        std::size_t threadsToWake = minimum(number, sleepingThreadsNum);
+        while (threadsToWake && !jobSystem->sleepingThreadsNum.compare_exchange_weak(sleepingThreadsNum, sleepingThreadsNum - threadsToWake, std::memory_order_seq_cst))
+        {
+            threadsToWake = minimum(number, sleepingThreadsNum);
+        }
+        if (threadsToWake)
+        {
+            jobSystem->wakeSemaphore.release(threadsToWake);
+        }
+    }
+
+    void start_job_after(JobSystem* jobSystem, Job* job, std::chrono::nanoseconds delay)
+    {
+        using namespace job_system_private;
+        job->timerType = JobTimerType::TIME;
+        job->timerDeadline = get_current_timer_tick(jobSystem) + to_timer_ticks(delay);
+        add_job_to_timers(jobSystem, job);
+    }
+
+    void start_job_at_frame(JobSystem* jobSystem, Job* job, uint64_t frame)
+    {
+        using namespace job_system_private;
+        job->timerType = JobTimerType::FRAME;
+        job->timerDeadline = frame;
+        add_job_to_timers(jobSystem, job);
+    }
+
+    void start_job_periodic(JobSystem* jobSystem, Job* job, std::chrono::nanoseconds period)
+    {
+        using namespace job_system_private;
+        job->timerPeriod = maximum(to_timer_ticks(period), uint64_t{ 1 });
+        start_job_after(jobSystem, job, period);
+    }
+
+    void start_job_every_frames(JobSystem* jobSystem, Job* job, uint64_t frames)
+    {
+        job->timerPeriod = maximum(frames, uint64_t{ 1 });
+        start_job_at_frame(jobSystem, job, std::atomic_load_explicit(&jobSystem->frameNumber, std::memory_order_relaxed) + job->timerPeriod);
+    }
+
+    void stop_periodic_job(Job* job)
+    {
+        // @NOTE :  Job pointer must not be used after this call - job is returned to the
+        //          free jobs queue the next time it fires
+        std::atomic_store_explicit(&job->timerStopRequested, true, std::memory_order_relaxed);
+    }
+
+    void reschedule_periodic_job(JobSystem* jobSystem, Job* job)
+    {
+        using namespace job_system_private;
+        // @NOTE :  Deadline is advanced from the previous deadline, not from the current
+        //          time, so periodic job doesn't drift
+        job->timerDeadline += job->timerPeriod;
+        add_job_to_timers(jobSystem, job);
+    }
+
+    void advance_frame(JobSystem* jobSystem)
+    {
+        std::atomic_fetch_add_explicit(&jobSystem->frameNumber, 1, std::memory_order_relaxed);
+    }
+
+    bool advance_timers(JobSystem* jobSystem)
+    {
+        using namespace job_system_private;
+        if (jobSystem->timersLock.test_and_set(std::memory_order_acquire))
+        {
+            // Other thread is already advancing timers
+            return false;
+        }
+        Job* job = nullptr;
+        while (jobSystem->pendingTimers.dequeue(&job))
+        {
+            timer_wheel_insert(job->timerType == JobTimerType::FRAME ? &jobSystem->frameWheel : &jobSystem->timeWheel, job);
+        }
+        Job* expiredJobs[2] =
+        {
+            timer_wheel_advance(&jobSystem->timeWheel, get_current_timer_tick(jobSystem)),
+            timer_wheel_advance(&jobSystem->frameWheel, std::atomic_load_explicit(&jobSystem->frameNumber, std::memory_order_relaxed))
+        };
+        jobSystem->timersLock.clear(std::memory_order_release);
+        // @NOTE :  Expired jobs are added to the queue in batches
+        constexpr std::size_t BATCH_SIZE = 64;
+        Job* batch[BATCH_SIZE];
+        std::size_t batchSize = 0;
+        bool result = false;
+        for (Job* expired : expiredJobs)
+        {
+            while (expired)
+            {
+                Job* next = expired->timerNext;
+                expired->timerNext = nullptr;
+                if (std::atomic_load_explicit(&expired->timerStopRequested, std::memory_order_relaxed))
+                {
+                    std::atomic_store_explicit(&expired->previousJobsNum, 0, std::memory_order_relaxed);
+                    return_job(jobSystem, expired);
+                }
+                else
+                {
+                    batch[batchSize++] = expired;
+                }
+                if (batchSize == BATCH_SIZE)
+                {
+                    start_jobs(jobSystem, { batch, batchSize });
+                    batchSize = 0;
+                }
+                expired = next;
+                result = true;
+            }
+        }
+        if (batchSize)
+        {
+            start_jobs(jobSystem, { batch, batchSize });
+        }
+        return result;
+    }
 }
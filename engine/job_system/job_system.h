@@ -1,11 +1,15 @@
 #ifndef AL_JOB_SYSTEM_H
 #define AL_JOB_SYSTEM_H
 
-#include <cstddef>  // for std::size_t
-#include <span>     // for std::span
+#include <cstddef>      // for std::size_t
+#include <span>         // for std::span
+#include <atomic>       // for std::atomic
+#include <semaphore>    // for std::counting_semaphore
+#include <chrono>       // for std::chrono::steady_clock
 
 #include "job_system_job.h"
 #include "job_system_thread.h"
+#include "job_system_timer_wheel.h"
 #include "engine/config/engine_config.h"
 
 #include "utilities/thread_safe/thread_safe_queue.h"
@@ -14,27 +18,66 @@ namespace al::engine
 {
     extern struct JobSystem* gMainJobSystem;
     extern struct JobSystem* gRenderJobSystem;
+    extern struct JobSystem* gIoJobSystem;      // @NOTE :  Used for blocking I/O, so main job system threads never wait for disk
 
-    extern Job                                                 gJobs[EngineConfig::MAX_JOBS];   // Stores actual job objects
-    extern StaticThreadSafeQueue<Job*, EngineConfig::MAX_JOBS> gFreeJobs;                       // Stores unused jobs
+    struct alignas(EngineConfig::CACHE_LINE_SIZE) JobPayloadOverflowBlock
+    {
+        std::byte memory[EngineConfig::JOB_PAYLOAD_OVERFLOW_BLOCK_SIZE];
+    };
+
+    extern Job                                                                                  gJobs[EngineConfig::MAX_JOBS];                                      // Stores actual job objects
+    extern StaticThreadSafeQueue<Job*, EngineConfig::MAX_JOBS>                                  gFreeJobs;                                                          // Stores unused jobs
+    extern JobPayloadOverflowBlock                                                              gJobPayloadOverflowBlocks[EngineConfig::JOB_PAYLOAD_OVERFLOW_BLOCKS];  // Stores payloads which are too big for Job::payload
+    extern StaticThreadSafeQueue<std::byte*, EngineConfig::JOB_PAYLOAD_OVERFLOW_BLOCKS>         gFreeJobPayloadOverflowBlocks;                                      // Stores unused overflow blocks
 
     struct JobSystem
     {
         std::span<JobSystemThread>                          threads;
-        StaticThreadSafeQueue<Job*, EngineConfig::MAX_JOBS> jobQueue; // Stores jobs that are ready for dispatch
+        // @NOTE :  Capacity of jobQueue is equal to the size of global job pool (gJobs), so queue can't overflow :
+        //          each job is in the queue at most once. start_jobs relies on this (enqueue_bulk can't fail and
+        //          waits for a free cell), so these sizes must be changed together.
+        StaticThreadSafeQueue<Job*, EngineConfig::MAX_JOBS> jobQueue;           // Stores jobs that are ready for dispatch
+        std::atomic<std::size_t>                            sleepingThreadsNum; // Number of threads currently waiting in wakeSemaphore
+        std::counting_semaphore<EngineConfig::MAX_JOBS>     wakeSemaphore;      // Idle threads wait on this semaphore
+        // @NOTE :  Delayed jobs are pushed to pendingTimers from any thread and moved to the timer
+        //          wheels by the thread which advances timers (see advance_timers). There is no
+        //          dedicated timer thread - idle worker threads advance timers before going to sleep,
+        //          so timers of job system without threads are never advanced.
+        StaticThreadSafeQueue<Job*, EngineConfig::MAX_JOBS> pendingTimers;
+        JobTimerWheel                                       timeWheel;
+        JobTimerWheel                                       frameWheel;
+        std::atomic_flag                                    timersLock;
+        std::atomic<uint64_t>                               frameNumber;
+        std::chrono::steady_clock::time_point               timersStartTime;
     };
 
     void init_jobs();
 
-    void construct(JobSystem* jobSystem, std::size_t numThreads);
+    // @NOTE :  Threads of high priority job system raise their own priority when started (see set_current_thread_highest_priority)
+    void construct(JobSystem* jobSystem, std::size_t numThreads, bool isHighPriority = false);
     void destruct(JobSystem* jobSystem);
 
+    std::byte*  get_job_payload_overflow_block      ();
+    void        return_job_payload_overflow_block   (std::byte* block);
+
     Job* get_job            (JobSystem* jobSystem);
     void return_job         (JobSystem* jobSystem, Job* job);
     void start_job          (JobSystem* jobSystem, Job* job);
+    void start_jobs         (JobSystem* jobSystem, std::span<Job*> jobs);
     void add_job_to_queue   (JobSystem* jobSystem, Job* job);
     Job* get_job_from_queue (JobSystem* jobSystem);
     void wait_for           (JobSystem* jobSystem, Job* job);
+    void wait_for_jobs      (JobSystem* jobSystem);
+    void wake_threads       (JobSystem* jobSystem, std::size_t number);
+
+    void start_job_after        (JobSystem* jobSystem, Job* job, std::chrono::nanoseconds delay);
+    void start_job_at_frame     (JobSystem* jobSystem, Job* job, uint64_t frame);
+    void start_job_periodic     (JobSystem* jobSystem, Job* job, std::chrono::nanoseconds period);
+    void start_job_every_frames (JobSystem* jobSystem, Job* job, uint64_t frames);
+    void stop_periodic_job      (Job* job);
+    void reschedule_periodic_job(JobSystem* jobSystem, Job* job);
+    void advance_frame          (JobSystem* jobSystem);
+    bool advance_timers         (JobSystem* jobSystem);
 
 }
 
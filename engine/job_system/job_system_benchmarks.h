@@ -0,0 +1,308 @@
+#ifndef AL_JOB_SYSTEM_BENCHMARKS_H
+#define AL_JOB_SYSTEM_BENCHMARKS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>      // for std::rand
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>    // for std::sort
+#include <iostream>
+
+#include "job_system.h"
+#include "engine/config/engine_config.h"
+#include "engine/memory/memory_manager.h"
+
+#include "utilities/constexpr_functions.h"
+
+// @NOTE :  Job system benchmarks. Results are written to the given stream as JSON :
+//          one entry per benchmark and per number of worker threads. Every benchmark
+//          reports jobs per second, wake up latency benchmark also reports latency
+//          percentiles in microseconds.
+
+namespace al::engine::test
+{
+    using BenchmarkClock    = std::chrono::steady_clock;
+    using BenchmarkTime     = BenchmarkClock::time_point;
+
+    struct JobSystemBenchmarkSettings
+    {
+        const std::size_t EMPTY_JOBS_NUM;
+        const std::size_t CHAIN_LENGTH;
+        const std::size_t CHAINS_NUM;
+        const std::size_t FAN_OUT_ITERATIONS;
+        const std::size_t NESTED_PARENT_JOBS_NUM;
+        const std::size_t NESTED_CHILD_JOBS_NUM;
+        const std::size_t MIXED_JOBS_NUM;
+        const std::size_t MIXED_JOB_MAX_DURATION_US;
+        const std::size_t WAKE_UP_SAMPLES_NUM;
+        const std::chrono::microseconds WAKE_UP_IDLE_TIME;
+    };
+
+    struct JobSystemBenchmarkResult
+    {
+        std::size_t jobsNum;
+        double      seconds;
+        double      latencyP50Us;
+        double      latencyP90Us;
+        double      latencyP99Us;
+        double      latencyMaxUs;
+    };
+
+    // @NOTE :  Job pool is shared by all job systems, so benchmarks never keep
+    //          more than this number of jobs in flight
+    static constexpr std::size_t BENCHMARK_MAX_JOBS_IN_FLIGHT   = EngineConfig::MAX_JOBS / 2;
+    static constexpr std::size_t BENCHMARK_SUBMIT_BATCH_SIZE    = 128;
+
+    inline double to_seconds(BenchmarkTime begin, BenchmarkTime end)
+    {
+        return std::chrono::duration<double>(end - begin).count();
+    }
+
+    void wait_for_counter(std::atomic<std::size_t>* counter, std::size_t value)
+    {
+        while (counter->load(std::memory_order_acquire) < value)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    void spin_for(std::chrono::microseconds time)
+    {
+        const BenchmarkTime end = BenchmarkClock::now() + time;
+        while (BenchmarkClock::now() < end)
+        { }
+    }
+
+    // @NOTE :  Submits jobsNum jobs in batches with start_jobs. Each job runs func and then increments
+    //          counter. prepare is called for each job before it is started (e.g. to set up a payload).
+    template<typename Func, typename Prepare>
+    void submit_counted_jobs(JobSystem* jobSystem, std::atomic<std::size_t>* counter, std::size_t jobsNum, Func func, Prepare prepare)
+    {
+        Job* batch[BENCHMARK_SUBMIT_BATCH_SIZE];
+        std::size_t submitted = 0;
+        while (submitted < jobsNum)
+        {
+            if (submitted - counter->load(std::memory_order_acquire) + BENCHMARK_SUBMIT_BATCH_SIZE > BENCHMARK_MAX_JOBS_IN_FLIGHT)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            const std::size_t batchSize = minimum(BENCHMARK_SUBMIT_BATCH_SIZE, jobsNum - submitted);
+            for (std::size_t it = 0; it < batchSize; it++)
+            {
+                batch[it] = get_job(jobSystem);
+                configure(batch[it], [counter, func](Job* job)
+                {
+                    func(job);
+                    counter->fetch_add(1, std::memory_order_release);
+                });
+                prepare(batch[it]);
+            }
+            start_jobs(jobSystem, { batch, batchSize });
+            submitted += batchSize;
+        }
+    }
+
+    JobSystemBenchmarkResult benchmark_empty_jobs(JobSystem* jobSystem, JobSystemBenchmarkSettings settings)
+    {
+        std::atomic<std::size_t> counter{ 0 };
+        const BenchmarkTime begin = BenchmarkClock::now();
+        submit_counted_jobs(jobSystem, &counter, settings.EMPTY_JOBS_NUM, [](Job*) { }, [](Job*) { });
+        wait_for_counter(&counter, settings.EMPTY_JOBS_NUM);
+        return { settings.EMPTY_JOBS_NUM, to_seconds(begin, BenchmarkClock::now()) };
+    }
+
+    JobSystemBenchmarkResult benchmark_dependency_chains(JobSystem* jobSystem, JobSystemBenchmarkSettings settings)
+    {
+        al_assert(settings.CHAIN_LENGTH <= BENCHMARK_MAX_JOBS_IN_FLIGHT);
+        std::atomic<std::size_t> counter{ 0 };
+        Job* chain[BENCHMARK_MAX_JOBS_IN_FLIGHT];
+        const BenchmarkTime begin = BenchmarkClock::now();
+        for (std::size_t chainIt = 0; chainIt < settings.CHAINS_NUM; chainIt++)
+        {
+            for (std::size_t it = 0; it < settings.CHAIN_LENGTH; it++)
+            {
+                chain[it] = get_job(jobSystem);
+                configure(chain[it], [&counter](Job*) { counter.fetch_add(1, std::memory_order_release); });
+                if (it != 0)
+                {
+                    set_after(chain[it], chain[it - 1]);
+                }
+            }
+            // @NOTE :  Only the first job is ready, others are started by their predecessors
+            start_jobs(jobSystem, { chain, settings.CHAIN_LENGTH });
+            wait_for_counter(&counter, (chainIt + 1) * settings.CHAIN_LENGTH);
+        }
+        return { settings.CHAIN_LENGTH * settings.CHAINS_NUM, to_seconds(begin, BenchmarkClock::now()) };
+    }
+
+    JobSystemBenchmarkResult benchmark_fan_out_fan_in(JobSystem* jobSystem, JobSystemBenchmarkSettings settings)
+    {
+        // @NOTE :  Fan out width is limited by the number of jobs which can wait for a single job
+        static constexpr std::size_t WIDTH = EngineConfig::MAX_NEXT_JOBS;
+        std::atomic<std::size_t> counter{ 0 };
+        const BenchmarkTime begin = BenchmarkClock::now();
+        for (std::size_t iteration = 0; iteration < settings.FAN_OUT_ITERATIONS; iteration++)
+        {
+            Job* jobs[WIDTH + 2];
+            Job* root = jobs[0] = get_job(jobSystem);
+            Job* sink = jobs[WIDTH + 1] = get_job(jobSystem);
+            configure(root, [&counter](Job*) { counter.fetch_add(1, std::memory_order_release); });
+            configure(sink, [&counter](Job*) { counter.fetch_add(1, std::memory_order_release); });
+            for (std::size_t it = 1; it <= WIDTH; it++)
+            {
+                jobs[it] = get_job(jobSystem);
+                configure(jobs[it], [&counter](Job*) { counter.fetch_add(1, std::memory_order_release); });
+                set_after(jobs[it], root);
+                set_after(sink, jobs[it]);
+            }
+            start_jobs(jobSystem, { jobs, WIDTH + 2 });
+            wait_for_counter(&counter, (iteration + 1) * (WIDTH + 2));
+        }
+        return { settings.FAN_OUT_ITERATIONS * (WIDTH + 2), to_seconds(begin, BenchmarkClock::now()) };
+    }
+
+    JobSystemBenchmarkResult benchmark_nested_wait(JobSystem* jobSystem, JobSystemBenchmarkSettings settings)
+    {
+        // @NOTE :  Each parent job starts child jobs and helps to dispatch queued jobs while waiting for them
+        const std::size_t jobsPerParent = settings.NESTED_CHILD_JOBS_NUM + 1;
+        al_assert(jobsPerParent * settings.NESTED_PARENT_JOBS_NUM <= EngineConfig::MAX_JOBS);
+        std::atomic<std::size_t> counter{ 0 };
+        const BenchmarkTime begin = BenchmarkClock::now();
+        for (std::size_t it = 0; it < settings.NESTED_PARENT_JOBS_NUM; it++)
+        {
+            Job* parent = get_job(jobSystem);
+            const std::size_t childJobsNum = settings.NESTED_CHILD_JOBS_NUM;
+            configure(parent, [&counter, jobSystem, childJobsNum](Job*)
+            {
+                // @NOTE :  Children are joined with a counter instead of wait_for(jobSystem, child),
+                //          because child jobs are returned to the pool (and can be reused) right after
+                //          they finish. Helping loop is the same as in wait_for.
+                std::atomic<std::size_t> childCounter{ 0 };
+                for (std::size_t childIt = 0; childIt < childJobsNum; childIt++)
+                {
+                    Job* child = get_job(jobSystem);
+                    configure(child, [&childCounter](Job*) { childCounter.fetch_add(1, std::memory_order_release); });
+                    start_job(jobSystem, child);
+                }
+                while (childCounter.load(std::memory_order_acquire) < childJobsNum)
+                {
+                    Job* otherJob = get_job_from_queue(jobSystem);
+                    if (otherJob)
+                    {
+                        dispatch(otherJob);
+                    }
+                }
+                counter.fetch_add(childJobsNum + 1, std::memory_order_release);
+            });
+            start_job(jobSystem, parent);
+        }
+        wait_for_counter(&counter, jobsPerParent * settings.NESTED_PARENT_JOBS_NUM);
+        return { jobsPerParent * settings.NESTED_PARENT_JOBS_NUM, to_seconds(begin, BenchmarkClock::now()) };
+    }
+
+    JobSystemBenchmarkResult benchmark_mixed_duration(JobSystem* jobSystem, JobSystemBenchmarkSettings settings)
+    {
+        std::atomic<std::size_t> counter{ 0 };
+        const std::size_t maxDuration = settings.MIXED_JOB_MAX_DURATION_US;
+        const BenchmarkTime begin = BenchmarkClock::now();
+        submit_counted_jobs(jobSystem, &counter, settings.MIXED_JOBS_NUM, [](Job* job)
+        {
+            spin_for(std::chrono::microseconds{ *get_payload<std::size_t>(job) });
+        },
+        [maxDuration](Job* job)
+        {
+            emplace_payload<std::size_t>(job, static_cast<std::size_t>(std::rand()) % maxDuration + 1);
+        });
+        wait_for_counter(&counter, settings.MIXED_JOBS_NUM);
+        return { settings.MIXED_JOBS_NUM, to_seconds(begin, BenchmarkClock::now()) };
+    }
+
+    JobSystemBenchmarkResult benchmark_wake_up_latency(JobSystem* jobSystem, JobSystemBenchmarkSettings settings)
+    {
+        // @NOTE :  Single job is started after workers went idle. Latency is the time
+        //          between start_job call and the beginning of job dispatch.
+        double* latencies = reinterpret_cast<double*>(MemoryManager::get_pool()->allocate(sizeof(double) * settings.WAKE_UP_SAMPLES_NUM));
+        std::atomic<std::size_t> counter{ 0 };
+        const BenchmarkTime begin = BenchmarkClock::now();
+        for (std::size_t it = 0; it < settings.WAKE_UP_SAMPLES_NUM; it++)
+        {
+            std::this_thread::sleep_for(settings.WAKE_UP_IDLE_TIME);
+            Job* job = get_job(jobSystem);
+            configure(job, [&counter, latencies, it](Job* job)
+            {
+                const BenchmarkTime dispatchTime = BenchmarkClock::now();
+                latencies[it] = std::chrono::duration<double, std::micro>(dispatchTime - *get_payload<BenchmarkTime>(job)).count();
+                counter.fetch_add(1, std::memory_order_release);
+            });
+            emplace_payload<BenchmarkTime>(job, BenchmarkClock::now());
+            start_job(jobSystem, job);
+            wait_for_counter(&counter, it + 1);
+        }
+        const double seconds = to_seconds(begin, BenchmarkClock::now());
+        std::sort(latencies, latencies + settings.WAKE_UP_SAMPLES_NUM);
+        auto percentile = [&](double value) -> double
+        {
+            const std::size_t index = static_cast<std::size_t>(value * static_cast<double>(settings.WAKE_UP_SAMPLES_NUM - 1));
+            return latencies[index];
+        };
+        JobSystemBenchmarkResult result{ settings.WAKE_UP_SAMPLES_NUM, seconds, percentile(0.5), percentile(0.9), percentile(0.99), percentile(1.0) };
+        MemoryManager::get_pool()->deallocate(reinterpret_cast<std::byte*>(latencies), sizeof(double) * settings.WAKE_UP_SAMPLES_NUM);
+        return result;
+    }
+
+    void write_benchmark_result(std::ostream& stream, const char* name, std::size_t threadsNum, JobSystemBenchmarkResult result, bool hasLatency, bool isLast)
+    {
+        stream << "    { \"benchmark\": \"" << name << "\", \"threads\": " << threadsNum
+               << ", \"jobs\": " << result.jobsNum
+               << ", \"seconds\": " << result.seconds
+               << ", \"jobs_per_second\": " << (result.seconds > 0.0 ? static_cast<double>(result.jobsNum) / result.seconds : 0.0);
+        if (hasLatency)
+        {
+            stream << ", \"latency_us\": { \"p50\": " << result.latencyP50Us
+                   << ", \"p90\": " << result.latencyP90Us
+                   << ", \"p99\": " << result.latencyP99Us
+                   << ", \"max\": " << result.latencyMaxUs << " }";
+        }
+        stream << " }" << (isLast ? "" : ",") << std::endl;
+    }
+
+    void run_job_system_benchmarks(std::ostream& stream, std::size_t maxThreadsNum)
+    {
+        const JobSystemBenchmarkSettings settings
+        {
+            .EMPTY_JOBS_NUM             = 1000000,
+            .CHAIN_LENGTH               = 256,
+            .CHAINS_NUM                 = 200,
+            .FAN_OUT_ITERATIONS         = 2000,
+            .NESTED_PARENT_JOBS_NUM     = 16,
+            .NESTED_CHILD_JOBS_NUM      = 32,
+            .MIXED_JOBS_NUM             = 50000,
+            .MIXED_JOB_MAX_DURATION_US  = 100,
+            .WAKE_UP_SAMPLES_NUM        = 1000,
+            .WAKE_UP_IDLE_TIME          = std::chrono::microseconds{ 500 }
+        };
+
+        stream << "{" << std::endl;
+        stream << "  \"job_thread_sleep_time_ns\": " << EngineConfig::JOB_THREAD_SLEEP_TIME.count() << "," << std::endl;
+        stream << "  \"results\": [" << std::endl;
+        for (std::size_t threadsNum = 1; threadsNum <= maxThreadsNum; threadsNum++)
+        {
+            JobSystem* jobSystem = MemoryManager::get_stack()->allocate_as<JobSystem>();
+            construct(jobSystem, threadsNum);
+            write_benchmark_result(stream, "empty_jobs"         , threadsNum, benchmark_empty_jobs(jobSystem, settings)         , false, false);
+            write_benchmark_result(stream, "dependency_chains"  , threadsNum, benchmark_dependency_chains(jobSystem, settings)  , false, false);
+            write_benchmark_result(stream, "fan_out_fan_in"     , threadsNum, benchmark_fan_out_fan_in(jobSystem, settings)     , false, false);
+            write_benchmark_result(stream, "nested_wait"        , threadsNum, benchmark_nested_wait(jobSystem, settings)        , false, false);
+            write_benchmark_result(stream, "mixed_duration"     , threadsNum, benchmark_mixed_duration(jobSystem, settings)     , false, false);
+            write_benchmark_result(stream, "wake_up_latency"    , threadsNum, benchmark_wake_up_latency(jobSystem, settings)    , true , threadsNum == maxThreadsNum);
+            destruct(jobSystem);
+        }
+        stream << "  ]" << std::endl;
+        stream << "}" << std::endl;
+    }
+}
+
+#endif
@@ -10,6 +10,13 @@ namespace al::engine
         job->previousJobsNum = 0;
         job->jobSystem = jobSystem;
         job->userData = nullptr;
+        job->payloadPointer = nullptr;
+        job->payloadDestructor = nullptr;
+        job->timerNext = nullptr;
+        job->timerDeadline = 0;
+        job->timerPeriod = 0;
+        job->timerType = JobTimerType::NONE;
+        std::atomic_store_explicit(&job->timerStopRequested, false, std::memory_order_relaxed);
         construct(&job->nextJobs);
     }
 
@@ -79,6 +86,12 @@ namespace al::engine
     void finish(Job* job)
     {
         al_assert(is_ready_for_dispatch(job));
+        if (is_periodic_job_active(job))
+        {
+            // @NOTE :  Periodic job stays ready for dispatch and goes back to the timer wheel
+            reschedule_periodic_job(job->jobSystem, job);
+            return;
+        }
         std::atomic_fetch_sub_explicit(&job->previousJobsNum, 1, std::memory_order_relaxed);
         for_each_array_container(job->nextJobs, it)
         {
@@ -88,4 +101,61 @@ namespace al::engine
         clear(&job->nextJobs);
         return_job(job->jobSystem, job);
     }
+
+    void destroy_payload(Job* job)
+    {
+        if (!job->payloadPointer)
+        {
+            return;
+        }
+        if (job->payloadDestructor)
+        {
+            job->payloadDestructor(job->payloadPointer);
+        }
+        if (job->payloadPointer != job->payload)
+        {
+            return_job_payload_overflow_block(reinterpret_cast<std::byte*>(job->payloadPointer));
+        }
+        job->payloadPointer = nullptr;
+        job->payloadDestructor = nullptr;
+    }
+
+    bool is_periodic_job_active(Job* job)
+    {
+        return job->timerPeriod != 0 && !std::atomic_load_explicit(&job->timerStopRequested, std::memory_order_relaxed);
+    }
+
+    template<typename T, typename ... Args>
+    T* emplace_payload(Job* job, Args ... args)
+    {
+        static_assert(alignof(T) <= EngineConfig::CACHE_LINE_SIZE, "Job payload alignment is too big");
+        static_assert(sizeof(T) <= EngineConfig::JOB_PAYLOAD_OVERFLOW_BLOCK_SIZE, "Job payload is too big. Consider increasing EngineConfig::JOB_PAYLOAD_OVERFLOW_BLOCK_SIZE value.");
+        al_assert_msg(!job->payloadPointer, "Job already has a payload");
+        std::byte* memory = nullptr;
+        if constexpr (sizeof(T) <= EngineConfig::JOB_INLINE_PAYLOAD_SIZE)
+        {
+            memory = job->payload;
+        }
+        else
+        {
+            memory = get_job_payload_overflow_block();
+        }
+        T* payload = ::new(memory) T{ args... };
+        job->payloadPointer = payload;
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            job->payloadDestructor = [](void* ptr)
+            {
+                reinterpret_cast<T*>(ptr)->~T();
+            };
+        }
+        return payload;
+    }
+
+    template<typename T>
+    T* get_payload(Job* job)
+    {
+        al_assert_msg(job->payloadPointer, "Job has no payload");
+        return reinterpret_cast<T*>(job->payloadPointer);
+    }
 }
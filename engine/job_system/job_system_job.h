@@ -1,9 +1,12 @@
 #ifndef AL_JOB_SYSTEM_JOB_H
 #define AL_JOB_SYSTEM_JOB_H
 
-#include <cstddef>  // for std::size_t and std::byte
-#include <atomic>   // for std::atomic
-#include <new>      // for std::hardware_destructive_interference_size
+#include <cstddef>      // for std::size_t and std::byte
+#include <cstdint>      // for uint64_t
+#include <atomic>       // for std::atomic
+#include <type_traits>  // for std::is_trivially_destructible_v
+
+#include "engine/config/engine_config.h"
 
 #include "utilities/non_copyable.h"
 #include "utilities/function.h"
@@ -13,17 +16,40 @@ namespace al::engine
 {
     class JobSystem;
 
+    enum class JobTimerType : uint8_t
+    {
+        NONE,
+        TIME,   // Job::timerDeadline and Job::timerPeriod are measured in EngineConfig::JOB_TIMER_WHEEL_TICK
+        FRAME   // Job::timerDeadline and Job::timerPeriod are measured in frames
+    };
+
+    static_assert(EngineConfig::JOB_INLINE_PAYLOAD_SIZE % EngineConfig::CACHE_LINE_SIZE == 0, "Job payload size must be a multiple of cache line size");
+
+    // @NOTE :  Job can store user data directly inside itself (see emplace_payload and get_payload).
+    //          If payload type is bigger than EngineConfig::JOB_INLINE_PAYLOAD_SIZE, it is placed
+    //          in one of the overflow blocks (see gJobPayloadOverflowBlocks in job_system.h).
+    //          Payload is destroyed when job is returned to the free jobs queue.
     struct Job
     {
         using DispatchFunction  = Function<void(Job*)>;
-        using CachelinePadding  = std::byte[std::hardware_destructive_interference_size];
+        using CachelinePadding  = std::byte[EngineConfig::CACHE_LINE_SIZE];
         using NextJobs          = ArrayContainer<Job*, EngineConfig::MAX_NEXT_JOBS>;
+        using Payload           = std::byte[EngineConfig::JOB_INLINE_PAYLOAD_SIZE];
+        using PayloadDestructor = void(*)(void*);
 
         NextJobs                    nextJobs;
         std::atomic<std::size_t>    previousJobsNum;
         DispatchFunction            dispatchFunction;
         JobSystem*                  jobSystem;
         void*                       userData;
+        void*                       payloadPointer;     // Points to payload or to overflow block. nullptr if job has no payload
+        PayloadDestructor           payloadDestructor;  // nullptr if payload is trivially destructible
+        Job*                        timerNext;          // Next job in the same timer wheel slot
+        uint64_t                    timerDeadline;      // Tick or frame at which delayed job is added to the queue
+        uint64_t                    timerPeriod;        // Non-zero for periodic jobs
+        JobTimerType                timerType;
+        std::atomic<bool>           timerStopRequested; // Periodic job is finished normally at the next dispatch
+        alignas(EngineConfig::CACHE_LINE_SIZE) Payload payload;
         CachelinePadding            padding;
     };
 
@@ -37,6 +63,11 @@ namespace al::engine
     void    set_after                   (Job* job, Job* other);
     void    notify_previous_job_finished(Job* job);
     void    finish                      (Job* job);
+    void    destroy_payload             (Job* job);
+    bool    is_periodic_job_active      (Job* job);
+
+    template<typename T, typename ... Args> T*  emplace_payload (Job* job, Args ... args);
+    template<typename T>                    T*  get_payload     (Job* job);
 }
 
 #endif
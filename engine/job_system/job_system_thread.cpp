@@ -2,14 +2,18 @@
 #include "job_system_thread.h"
 #include "job_system_job.h"
 #include "job_system.h"
+#include "engine/platform/platform_thread_utilities.h"
+#include "engine/debug/debug.h"
 
 namespace al::engine
 {
-    void construct(JobSystemThread* thread, JobSystem* jobSystem)
+    void construct(JobSystemThread* thread, JobSystem* jobSystem, bool isHighPriority)
     {
-        thread->shouldRun   = true;
-        thread->thread      = { work, thread };
-        thread->jobSystem   = jobSystem;
+        // @NOTE :  Thread must be started last, because it immediately starts to use jobSystem pointer
+        thread->shouldRun       = true;
+        thread->jobSystem       = jobSystem;
+        thread->isHighPriority  = isHighPriority;
+        thread->thread          = std::thread{ work, thread };
     }
 
     void destruct(JobSystemThread* thread)
@@ -20,6 +24,10 @@ namespace al::engine
 
     void work(JobSystemThread* thread)
     {
+        if (thread->isHighPriority && !set_current_thread_highest_priority())
+        {
+            al_log_warning(EngineConfig::JOB_SYSTEM_LOG_CATEGORY, "Can't raise priority of job system thread");
+        }
         while(thread->shouldRun)
         {
             Job* job = get_job_from_queue(thread->jobSystem);
@@ -27,9 +35,9 @@ namespace al::engine
             {
                 dispatch(job);
             }
-            else
+            else if (!advance_timers(thread->jobSystem))
             {
-                std::this_thread::sleep_for(EngineConfig::JOB_THREAD_SLEEP_TIME);
+                wait_for_jobs(thread->jobSystem);
             }
         }
     }
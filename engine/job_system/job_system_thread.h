@@ -14,9 +14,10 @@ namespace al::engine
         std::atomic<bool> shouldRun;
         std::thread thread;
         JobSystem* jobSystem;
+        bool isHighPriority;
     };
 
-    void construct  (JobSystemThread* thread, JobSystem* jobSystem);
+    void construct  (JobSystemThread* thread, JobSystem* jobSystem, bool isHighPriority);
     void destruct   (JobSystemThread* thread);
     void work       (JobSystemThread* thread);
 }
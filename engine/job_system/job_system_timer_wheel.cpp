@@ -0,0 +1,108 @@
+
+#include <bit> // for std::countr_zero
+
+#include "job_system_timer_wheel.h"
+#include "job_system_job.h"
+
+#include "utilities/constexpr_functions.h"
+
+namespace al::engine
+{
+    namespace job_timer_wheel_private
+    {
+        static_assert(is_power_of_two(EngineConfig::JOB_TIMER_WHEEL_SLOTS), "Number of timer wheel slots must be power of two");
+
+        constexpr uint64_t SLOT_BITS    = std::countr_zero(EngineConfig::JOB_TIMER_WHEEL_SLOTS);
+        constexpr uint64_t SLOT_MASK    = EngineConfig::JOB_TIMER_WHEEL_SLOTS - 1;
+        constexpr uint64_t MAX_DELTA    = (uint64_t{1} << (SLOT_BITS * EngineConfig::JOB_TIMER_WHEEL_LEVELS)) - 1;
+
+        static_assert(SLOT_BITS * EngineConfig::JOB_TIMER_WHEEL_LEVELS < 64, "Timer wheel range doesn't fit into 64 bit tick");
+
+        // @NOTE :  Level is selected by distance to the slotTick, slot is selected by slotTick itself.
+        //          Jobs which are further than wheel range are placed to the last slot of the top level
+        //          and are placed again when this slot is cascaded.
+        void place(JobTimerWheel* wheel, Job* job, uint64_t slotTick)
+        {
+            const uint64_t delta = minimum(slotTick - wheel->currentTick, MAX_DELTA);
+            const uint64_t clampedTick = wheel->currentTick + delta;
+            std::size_t level = 0;
+            while (level < EngineConfig::JOB_TIMER_WHEEL_LEVELS - 1 && delta >= (uint64_t{1} << (SLOT_BITS * (level + 1))))
+            {
+                level++;
+            }
+            const std::size_t slot = (clampedTick >> (SLOT_BITS * level)) & SLOT_MASK;
+            job->timerNext = wheel->slots[level][slot];
+            wheel->slots[level][slot] = job;
+        }
+
+        void cascade(JobTimerWheel* wheel, std::size_t level)
+        {
+            const std::size_t slot = (wheel->currentTick >> (SLOT_BITS * level)) & SLOT_MASK;
+            Job* job = wheel->slots[level][slot];
+            wheel->slots[level][slot] = nullptr;
+            while (job)
+            {
+                Job* next = job->timerNext;
+                place(wheel, job, maximum(job->timerDeadline, wheel->currentTick));
+                job = next;
+            }
+        }
+    }
+
+    void construct(JobTimerWheel* wheel, uint64_t currentTick)
+    {
+        for (std::size_t level = 0; level < EngineConfig::JOB_TIMER_WHEEL_LEVELS; level++)
+        {
+            for (std::size_t slot = 0; slot < EngineConfig::JOB_TIMER_WHEEL_SLOTS; slot++)
+            {
+                wheel->slots[level][slot] = nullptr;
+            }
+        }
+        wheel->currentTick = currentTick;
+        wheel->timersNum = 0;
+    }
+
+    void timer_wheel_insert(JobTimerWheel* wheel, Job* job)
+    {
+        using namespace job_timer_wheel_private;
+        // @NOTE :  Slot of the current tick is already processed, so overdue jobs expire on the next tick
+        place(wheel, job, maximum(job->timerDeadline, wheel->currentTick + 1));
+        wheel->timersNum += 1;
+    }
+
+    Job* timer_wheel_advance(JobTimerWheel* wheel, uint64_t targetTick)
+    {
+        using namespace job_timer_wheel_private;
+        Job* expired = nullptr;
+        while (wheel->currentTick < targetTick)
+        {
+            if (wheel->timersNum == 0)
+            {
+                wheel->currentTick = targetTick;
+                break;
+            }
+            wheel->currentTick += 1;
+            // @NOTE :  Level is cascaded when all lower levels have wrapped around
+            for (std::size_t level = 1; level < EngineConfig::JOB_TIMER_WHEEL_LEVELS; level++)
+            {
+                if ((wheel->currentTick & ((uint64_t{1} << (SLOT_BITS * level)) - 1)) != 0)
+                {
+                    break;
+                }
+                cascade(wheel, level);
+            }
+            const std::size_t slot = wheel->currentTick & SLOT_MASK;
+            Job* job = wheel->slots[0][slot];
+            wheel->slots[0][slot] = nullptr;
+            while (job)
+            {
+                Job* next = job->timerNext;
+                job->timerNext = expired;
+                expired = job;
+                wheel->timersNum -= 1;
+                job = next;
+            }
+        }
+        return expired;
+    }
+}
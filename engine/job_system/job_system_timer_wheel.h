@@ -0,0 +1,31 @@
+#ifndef AL_JOB_SYSTEM_TIMER_WHEEL_H
+#define AL_JOB_SYSTEM_TIMER_WHEEL_H
+
+#include <cstddef>  // for std::size_t
+#include <cstdint>  // for uint64_t
+
+#include "engine/config/engine_config.h"
+
+namespace al::engine
+{
+    struct Job;
+
+    // @NOTE :  Hierarchical timer wheel. Each level 0 slot covers single tick, each slot of the
+    //          next level covers the whole previous level. Jobs are stored in intrusive lists
+    //          (Job::timerNext), so insertion is O(1) and every job is moved to a lower level at
+    //          most JOB_TIMER_WHEEL_LEVELS - 1 times before it expires.
+    //          Wheel is not thread-safe - JobSystem allows only one thread to work with it at a time.
+    struct JobTimerWheel
+    {
+        Job*        slots[EngineConfig::JOB_TIMER_WHEEL_LEVELS][EngineConfig::JOB_TIMER_WHEEL_SLOTS];
+        uint64_t    currentTick;
+        std::size_t timersNum;
+    };
+
+    void construct(JobTimerWheel* wheel, uint64_t currentTick);
+
+    void timer_wheel_insert (JobTimerWheel* wheel, Job* job);
+    Job* timer_wheel_advance(JobTimerWheel* wheel, uint64_t targetTick); // Returns expired jobs linked via Job::timerNext
+}
+
+#endif
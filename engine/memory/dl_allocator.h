@@ -17,7 +17,7 @@ namespace al::engine
 {
     class DlAllocator : public AllocatorBase
     {
-        virtual [[nodiscard]] std::byte* allocate(std::size_t memorySizeBytes) noexcept override;
+        [[nodiscard]] virtual std::byte* allocate(std::size_t memorySizeBytes) noexcept override;
         virtual void deallocate(std::byte* ptr, std::size_t memorySizeBytes) noexcept override;
     };
 }
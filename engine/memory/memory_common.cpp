@@ -15,4 +15,13 @@ namespace al::engine
         uint8_t* alignedPtr = reinterpret_cast<uint8_t*>(ptr) + diff;
         return reinterpret_cast<T*>(alignedPtr);
     }
+
+    // @NOTE :  Alignment must be power of two
+    template<typename T>
+    T* align_pointer(T* ptr, std::size_t alignment) noexcept
+    {
+        uintptr_t uintPtr = reinterpret_cast<uintptr_t>(ptr);
+        uintptr_t alignedUintPtr = (uintPtr + alignment - 1) & ~(uintptr_t{ alignment } - 1);
+        return reinterpret_cast<T*>(alignedUintPtr);
+    }
 }
@@ -8,6 +8,7 @@
 namespace al::engine
 {
     template<typename T> T* align_pointer(T* ptr) noexcept;
+    template<typename T> T* align_pointer(T* ptr, std::size_t alignment) noexcept;
 }
 
 #endif
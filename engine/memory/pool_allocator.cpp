@@ -1,6 +1,8 @@
 
 #include "pool_allocator.h"
+#include "memory_common.h"
 #include "utilities/procedural_wrap.h"
+#include "utilities/constexpr_functions.h"
 
 namespace al::engine
 {
@@ -24,7 +26,11 @@ namespace al::engine
         memorySizeBytes = blockSizeBytes * blockCount;
         ledgerSizeBytes = 1 + ((blockCount - 1) / 8);
 
-        memory = allocator->allocate(memorySizeBytes);
+        // @NOTE :  Bucket memory is aligned to the largest power of two which divides block size
+        //          (but not more than cache line size), so every block gets the same alignment.
+        //          ECS relies on this to align component arrays inside chunks.
+        const std::size_t alignment = minimum(lowest_set_bit(blockSizeBytes), EngineConfig::CACHE_LINE_SIZE);
+        memory = align_pointer(allocator->allocate(memorySizeBytes + alignment - 1), alignment);
         ledger = allocator->allocate(ledgerSizeBytes);
 
         std::memset(ledger, 0, ledgerSizeBytes);
@@ -76,6 +82,11 @@ namespace al::engine
         return blockCount != 0;
     }
 
+    const std::byte* MemoryBucket::get_memory() const noexcept
+    {
+        return memory;
+    }
+
     const std::byte* MemoryBucket::get_ledger() const noexcept
     {
         return ledger;
@@ -249,7 +260,7 @@ namespace al::engine
 
     void PoolAllocator::deallocate_using_allocation_info(std::byte* ptr) noexcept
     {
-        for_each_dynamic_array(ptrSizePairs, it)
+        for_each_array_container(ptrSizePairs, it)
         {
             AllocationInfo* allocationInfo = get(&ptrSizePairs, it);
             if (allocationInfo->ptr == ptr)
@@ -264,7 +275,7 @@ namespace al::engine
     [[nodiscard]] std::byte* PoolAllocator::reallocate_using_allocation_info(std::byte* ptr, std::size_t newMemorySizeBytes) noexcept
     {
         std::byte* newMemory = allocate_using_allocation_info(newMemorySizeBytes);
-        for_each_dynamic_array(ptrSizePairs, it)
+        for_each_array_container(ptrSizePairs, it)
         {
             AllocationInfo* allocationInfo = get(&ptrSizePairs, it);
             if (allocationInfo->ptr == ptr)
@@ -39,6 +39,7 @@ namespace al::engine
         const std::size_t           get_block_count         ()                                                                          const   noexcept;
         const bool                  is_bucket_initialized   ()                                                                          const   noexcept;
 
+        const std::byte*    get_memory              () const noexcept;
         const std::byte*    get_ledger              () const noexcept;
         const std::size_t   get_ledger_size_bytes   () const noexcept;
 
@@ -87,7 +88,7 @@ namespace al::engine
         PoolAllocator() = default;
         ~PoolAllocator() = default;
 
-        virtual [[nodiscard]] std::byte*    allocate    (std::size_t memorySizeBytes)                   noexcept override;
+        [[nodiscard]] virtual std::byte*    allocate    (std::size_t memorySizeBytes)                   noexcept override;
         virtual void                        deallocate  (std::byte* ptr, std::size_t memorySizeBytes)   noexcept override;
 
         void initialize(BucketDescContainer bucketDescriptions, AllocatorBase* allocator) noexcept;
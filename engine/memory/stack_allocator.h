@@ -16,7 +16,7 @@ namespace al::engine
         StackAllocator() noexcept;
         ~StackAllocator() noexcept;
 
-        virtual [[nodiscard]] std::byte* allocate(std::size_t memorySizeBytes) noexcept;
+        [[nodiscard]] virtual std::byte* allocate(std::size_t memorySizeBytes) noexcept;
         virtual void deallocate(std::byte*, std::size_t) noexcept override;
 
         void initialize(std::byte* memory, std::size_t memorySizeBytes) noexcept;
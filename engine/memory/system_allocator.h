@@ -12,7 +12,7 @@ namespace al::engine
     class SystemAllocator : public AllocatorBase
     {
     public:
-        virtual [[nodiscard]] std::byte* allocate(std::size_t memorySizeBytes) noexcept override;
+        [[nodiscard]] virtual std::byte* allocate(std::size_t memorySizeBytes) noexcept override;
         virtual void deallocate(std::byte* ptr, std::size_t memorySizeBytes) noexcept override;
     };
 }
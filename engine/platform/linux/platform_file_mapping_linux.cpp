@@ -0,0 +1,45 @@
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "engine/platform/platform_file_mapping.h"
+
+namespace al::engine
+{
+    bool platform_map_file(FileMapping* mapping, const char* path) noexcept
+    {
+        *mapping = { nullptr, 0, nullptr };
+        const int file = ::open(path, O_RDONLY);
+        if (file == -1)
+        {
+            return false;
+        }
+        struct stat fileStat;
+        if (::fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            ::close(file);
+            return false;
+        }
+        // @NOTE :  Mapping stays valid after file descriptor is closed
+        void* memory = ::mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+        ::close(file);
+        if (memory == MAP_FAILED)
+        {
+            return false;
+        }
+        mapping->memory = static_cast<std::byte*>(memory);
+        mapping->size = static_cast<std::size_t>(fileStat.st_size);
+        return true;
+    }
+
+    void platform_unmap_file(FileMapping* mapping) noexcept
+    {
+        if (mapping->memory)
+        {
+            ::munmap(mapping->memory, mapping->size);
+        }
+        *mapping = { nullptr, 0, nullptr };
+    }
+}
@@ -0,0 +1,179 @@
+
+#include <cstdio>   // for std::fopen, std::fgets, std::snprintf
+#include <cstdlib>  // for std::strtoull
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>         // for syscall
+#include <sys/syscall.h>    // for SYS_gettid
+#include <sys/resource.h>   // for setpriority
+
+#include "engine/platform/platform_thread_utilities.h"
+
+namespace al::engine
+{
+    namespace linux_thread_utilities_private
+    {
+        // @NOTE :  Parses cpu list files from /sys/devices/system/cpu (e.g. "0-3,8-11,16")
+        bool read_cpu_list(const char* path, cpu_set_t* set) noexcept
+        {
+            CPU_ZERO(set);
+            std::FILE* file = std::fopen(path, "r");
+            if (!file)
+            {
+                return false;
+            }
+            char buffer[4096];
+            const bool readResult = std::fgets(buffer, sizeof(buffer), file) != nullptr;
+            std::fclose(file);
+            if (!readResult)
+            {
+                return false;
+            }
+            char* current = buffer;
+            while (*current >= '0' && *current <= '9')
+            {
+                const std::size_t first = std::strtoull(current, &current, 10);
+                std::size_t last = first;
+                if (*current == '-')
+                {
+                    last = std::strtoull(current + 1, &current, 10);
+                }
+                for (std::size_t it = first; it <= last && it < CPU_SETSIZE; it++)
+                {
+                    CPU_SET(it, set);
+                }
+                if (*current == ',')
+                {
+                    current++;
+                }
+            }
+            return true;
+        }
+
+        std::size_t get_lowest_cpu(cpu_set_t* set, std::size_t fallback) noexcept
+        {
+            for (std::size_t it = 0; it < CPU_SETSIZE; it++)
+            {
+                if (CPU_ISSET(it, set))
+                {
+                    return it;
+                }
+            }
+            return fallback;
+        }
+
+        std::size_t get_cpu_position(cpu_set_t* set, std::size_t cpu) noexcept
+        {
+            std::size_t position = 0;
+            for (std::size_t it = 0; it < cpu && it < CPU_SETSIZE; it++)
+            {
+                position += CPU_ISSET(it, set) ? 1 : 0;
+            }
+            return position;
+        }
+    }
+
+    void query_cpu_topology(CpuTopology* topology) noexcept
+    {
+        using namespace linux_thread_utilities_private;
+        construct(&topology->logicalProcessors);
+        topology->physicalCoresNum = 0;
+        cpu_set_t onlineCpus;
+        if (!read_cpu_list("/sys/devices/system/cpu/online", &onlineCpus))
+        {
+            for (std::size_t it = 0; it < std::thread::hardware_concurrency(); it++)
+            {
+                CPU_SET(it, &onlineCpus);
+            }
+        }
+        // @NOTE :  Process might be restricted to a subset of cpus (taskset, cgroups)
+        cpu_set_t allowedCpus;
+        if (sched_getaffinity(0, sizeof(cpu_set_t), &allowedCpus) == 0)
+        {
+            CPU_AND(&onlineCpus, &onlineCpus, &allowedCpus);
+        }
+        char path[256];
+        for (std::size_t cpuIt = 0; cpuIt < CPU_SETSIZE; cpuIt++)
+        {
+            if (!CPU_ISSET(cpuIt, &onlineCpus))
+            {
+                continue;
+            }
+            CpuLogicalProcessor processor{ cpuIt, cpuIt, cpuIt, 0 };
+            cpu_set_t siblings;
+            std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%zu/topology/thread_siblings_list", cpuIt);
+            if (read_cpu_list(path, &siblings))
+            {
+                processor.coreId = get_lowest_cpu(&siblings, cpuIt);
+                processor.smtIndex = get_cpu_position(&siblings, cpuIt);
+            }
+            // @NOTE :  Last cache index directory describes last level cache
+            cpu_set_t cacheSharedCpus;
+            for (std::size_t cacheIt = 0; ; cacheIt++)
+            {
+                std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%zu/cache/index%zu/shared_cpu_list", cpuIt, cacheIt);
+                if (!read_cpu_list(path, &cacheSharedCpus))
+                {
+                    break;
+                }
+                processor.cacheDomainId = get_lowest_cpu(&cacheSharedCpus, cpuIt);
+            }
+            if (!push(&topology->logicalProcessors, processor))
+            {
+                break;
+            }
+            if (processor.smtIndex == 0)
+            {
+                topology->physicalCoresNum += 1;
+            }
+        }
+    }
+
+    bool set_thread_affinity_mask(ThreadHandle threadHandle, uint64_t mask) noexcept
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (std::size_t it = 0; it < 64; it++)
+        {
+            if (mask & (uint64_t{1} << it))
+            {
+                CPU_SET(it, &set);
+            }
+        }
+        return ::pthread_setaffinity_np(reinterpret_cast<pthread_t>(threadHandle), sizeof(cpu_set_t), &set) == 0;
+    }
+
+    bool set_thread_affinity_cpu(ThreadHandle threadHandle, std::size_t logicalProcessorId) noexcept
+    {
+        if (logicalProcessorId >= CPU_SETSIZE)
+        {
+            return false;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(logicalProcessorId, &set);
+        return ::pthread_setaffinity_np(reinterpret_cast<pthread_t>(threadHandle), sizeof(cpu_set_t), &set) == 0;
+    }
+
+    bool set_current_thread_highest_priority() noexcept
+    {
+        // @NOTE :  Realtime policies (SCHED_RR, SCHED_FIFO) are not used on purpose : engine threads
+        //          are busy most of the time and each one is pinned to a cpu, so they can starve the system.
+        //          Analog of win32 THREAD_PRIORITY_HIGHEST is a negative nice value within SCHED_OTHER,
+        //          which is set per kernel thread id. Lowering nice value requires CAP_SYS_NICE
+        //          (or RLIMIT_NICE), so for regular users this call fails and thread keeps default priority.
+        static constexpr int HIGHEST_PRIORITY_NICE_VALUE = -5;
+        const id_t threadId = static_cast<id_t>(::syscall(SYS_gettid));
+        return ::setpriority(PRIO_PROCESS, threadId, HIGHEST_PRIORITY_NICE_VALUE) == 0;
+    }
+
+    ThreadHandle get_current_thread_handle() noexcept
+    {
+        return reinterpret_cast<ThreadHandle>(::pthread_self());
+    }
+
+    ThreadHandle get_thread_handle(std::thread* thread) noexcept
+    {
+        return reinterpret_cast<ThreadHandle>(thread->native_handle());
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef AL_PLATFORM_FILE_MAPPING_H
+#define AL_PLATFORM_FILE_MAPPING_H
+
+#include <cstddef>  // for std::size_t, std::byte
+
+namespace al::engine
+{
+    // @NOTE :  Private copy-on-write mapping of the whole file. Memory can be written,
+    //          but changes are never stored to the file (pages are copied on the first write).
+    struct FileMapping
+    {
+        std::byte*  memory;
+        std::size_t size;
+        void*       nativeHandle;   // Mapping object handle on win32, unused on linux
+    };
+
+    bool platform_map_file      (FileMapping* mapping, const char* path) noexcept;
+    void platform_unmap_file    (FileMapping* mapping) noexcept;
+}
+
+#endif
@@ -2,14 +2,43 @@
 #define AL_PLATFORM_THREAD_UTILITIES_H
 
 #include <cstdint>
+#include <cstddef>  // for std::size_t
+#include <thread>   // for std::thread
+
+#include "engine/config/engine_config.h"
+
+#include "utilities/array_container.h"
 
 namespace al::engine
 {
     using ThreadHandle = void*;
 
-    bool set_thread_affinity_mask(ThreadHandle threadHandle, uint64_t mask) noexcept;
-    bool set_thread_highest_priority(ThreadHandle threadHandle) noexcept;
-    ThreadHandle get_current_thread_handle() noexcept;
+    // @NOTE :  Describes single logical processor (hardware thread) of the system.
+    //          coreId and cacheDomainId are the ids of the lowest logical processor which
+    //          shares the same physical core / the same last level cache with this processor,
+    //          so they are unique within the system.
+    struct CpuLogicalProcessor
+    {
+        std::size_t id;             // OS index of the logical processor
+        std::size_t coreId;         // Physical core of this logical processor
+        std::size_t cacheDomainId;  // Last level cache domain of this logical processor
+        std::size_t smtIndex;       // Index of this logical processor among SMT siblings of the same core
+    };
+
+    struct CpuTopology
+    {
+        ArrayContainer<CpuLogicalProcessor, EngineConfig::MAX_SUPPORTED_THREADS> logicalProcessors;
+        std::size_t physicalCoresNum;
+    };
+
+    void            query_cpu_topology          (CpuTopology* topology) noexcept;
+    bool            set_thread_affinity_mask    (ThreadHandle threadHandle, uint64_t mask) noexcept;
+    bool            set_thread_affinity_cpu     (ThreadHandle threadHandle, std::size_t logicalProcessorId) noexcept;
+    // @NOTE :  Priority is changed for the calling thread only, because on some platforms (linux) priority
+    //          of another thread can't be changed through it's handle. Threads raise their own priority when started.
+    bool            set_current_thread_highest_priority() noexcept;
+    ThreadHandle    get_current_thread_handle   () noexcept;
+    ThreadHandle    get_thread_handle           (std::thread* thread) noexcept;
 }
 
 #endif
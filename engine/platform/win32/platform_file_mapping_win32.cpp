@@ -0,0 +1,49 @@
+
+#include "engine/platform/win32/win32_backend.h"
+#include "engine/platform/platform_file_mapping.h"
+
+namespace al::engine
+{
+    bool platform_map_file(FileMapping* mapping, const char* path) noexcept
+    {
+        *mapping = { nullptr, 0, nullptr };
+        HANDLE file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        if (!::GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            ::CloseHandle(file);
+            return false;
+        }
+        // @NOTE :  Mapping object keeps the file open, so file handle can be closed right away
+        HANDLE mappingHandle = ::CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        ::CloseHandle(file);
+        if (!mappingHandle)
+        {
+            return false;
+        }
+        void* memory = ::MapViewOfFile(mappingHandle, FILE_MAP_COPY, 0, 0, 0);
+        if (!memory)
+        {
+            ::CloseHandle(mappingHandle);
+            return false;
+        }
+        mapping->memory = static_cast<std::byte*>(memory);
+        mapping->size = static_cast<std::size_t>(fileSize.QuadPart);
+        mapping->nativeHandle = mappingHandle;
+        return true;
+    }
+
+    void platform_unmap_file(FileMapping* mapping) noexcept
+    {
+        if (mapping->memory)
+        {
+            ::UnmapViewOfFile(mapping->memory);
+            ::CloseHandle(static_cast<HANDLE>(mapping->nativeHandle));
+        }
+        *mapping = { nullptr, 0, nullptr };
+    }
+}
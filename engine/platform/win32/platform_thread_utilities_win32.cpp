@@ -1,21 +1,110 @@
 
 #include "engine/platform/win32/win32_backend.h"
 #include "engine/platform/platform_thread_utilities.h"
+#include "engine/memory/memory_manager.h"
 
 namespace al::engine
 {
+    // @NOTE :  GetLogicalProcessorInformation describes only processor group
+    //          of the calling thread (up to 64 logical processors)
+    void query_cpu_topology(CpuTopology* topology) noexcept
+    {
+        construct(&topology->logicalProcessors);
+        topology->physicalCoresNum = 0;
+        DWORD bufferSize = 0;
+        ::GetLogicalProcessorInformation(nullptr, &bufferSize);
+        std::byte* buffer = MemoryManager::get_pool()->allocate(bufferSize);
+        SYSTEM_LOGICAL_PROCESSOR_INFORMATION* infos = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION*>(buffer);
+        const std::size_t infosNum = bufferSize / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
+        auto getLowestBit = [](ULONG_PTR mask) -> std::size_t
+        {
+            for (std::size_t it = 0; it < sizeof(ULONG_PTR) * 8; it++)
+            {
+                if (mask & (ULONG_PTR{1} << it))
+                {
+                    return it;
+                }
+            }
+            return 0;
+        };
+        if (buffer && ::GetLogicalProcessorInformation(infos, &bufferSize))
+        {
+            // Collect logical processors of each physical core
+            for (std::size_t infoIt = 0; infoIt < infosNum; infoIt++)
+            {
+                if (infos[infoIt].Relationship != RelationProcessorCore)
+                {
+                    continue;
+                }
+                const ULONG_PTR mask = infos[infoIt].ProcessorMask;
+                const std::size_t coreId = getLowestBit(mask);
+                std::size_t smtIndex = 0;
+                for (std::size_t it = 0; it < sizeof(ULONG_PTR) * 8; it++)
+                {
+                    if (mask & (ULONG_PTR{1} << it))
+                    {
+                        push(&topology->logicalProcessors, { it, coreId, coreId, smtIndex++ });
+                    }
+                }
+                topology->physicalCoresNum += 1;
+            }
+            // Assign last level cache domains
+            for (std::size_t infoIt = 0; infoIt < infosNum; infoIt++)
+            {
+                if (infos[infoIt].Relationship != RelationCache || infos[infoIt].Cache.Level != 3)
+                {
+                    continue;
+                }
+                const ULONG_PTR mask = infos[infoIt].ProcessorMask;
+                for_each_array_container(topology->logicalProcessors, it)
+                {
+                    CpuLogicalProcessor* processor = get(&topology->logicalProcessors, it);
+                    if (mask & (ULONG_PTR{1} << processor->id))
+                    {
+                        processor->cacheDomainId = getLowestBit(mask);
+                    }
+                }
+            }
+        }
+        else
+        {
+            for (std::size_t it = 0; it < std::thread::hardware_concurrency(); it++)
+            {
+                push(&topology->logicalProcessors, { it, it, it, 0 });
+            }
+            topology->physicalCoresNum = topology->logicalProcessors.size;
+        }
+        if (buffer)
+        {
+            MemoryManager::get_pool()->deallocate(buffer, bufferSize);
+        }
+    }
+
     bool set_thread_affinity_mask(ThreadHandle threadHandle, uint64_t mask) noexcept
     {
         return ::SetThreadAffinityMask(threadHandle, static_cast<DWORD_PTR>(mask));
     }
 
-    bool set_thread_highest_priority(ThreadHandle threadHandle) noexcept
+    bool set_thread_affinity_cpu(ThreadHandle threadHandle, std::size_t logicalProcessorId) noexcept
     {
-        return ::SetThreadPriority(threadHandle, THREAD_PRIORITY_HIGHEST);
+        GROUP_AFFINITY affinity{ };
+        affinity.Group = static_cast<WORD>(logicalProcessorId / 64);
+        affinity.Mask = KAFFINITY{1} << (logicalProcessorId % 64);
+        return ::SetThreadGroupAffinity(threadHandle, &affinity, nullptr);
+    }
+
+    bool set_current_thread_highest_priority() noexcept
+    {
+        return ::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
     }
 
     ThreadHandle get_current_thread_handle() noexcept
     {
         return ::GetCurrentThread();
     }
+
+    ThreadHandle get_thread_handle(std::thread* thread) noexcept
+    {
+        return thread->native_handle();
+    }
 }
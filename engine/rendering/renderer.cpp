@@ -3,6 +3,7 @@
 
 #include "engine/file_system/file_system.h"
 #include "engine/job_system/job_system.h"
+#include "engine/platform/platform_thread_utilities.h"
 
 #include "utilities/safe_cast.h"
 
@@ -235,6 +236,10 @@ namespace al::engine
 
     void Renderer::render_update() noexcept
     {
+        if (!set_current_thread_highest_priority())
+        {
+            al_log_warning(EngineConfig::RENDERER_LOG_CATEGORY, "Can't raise priority of render thread");
+        }
         initialize_renderer();
         {
             al_profile_scope("Renderer post-init");
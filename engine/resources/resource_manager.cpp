@@ -116,12 +116,12 @@ namespace al::engine
             handle.index = meshResources.get_direct_index(resource);
             construct(&resource->path, &path);
             construct(&resource->renderMesh.submeshes);
-            // @NOTE :  Step 2. Start loading that resource
-            auto [fileHandle, loadJob] = file_async_load(gFileSystem, path, FileLoadMode::READ);
-            // @NOTE :  Step 3. Start post load job
+            // @NOTE :  Step 2. Prepare post load job. File handle is passed to it through job payload
+            //          (see file_async_load)
             Job* postLoadJob = get_job(gMainJobSystem);
-            configure(postLoadJob, [fileHandle, resource](Job* job)
+            configure(postLoadJob, [resource](Job* job)
             {
+                FileHandle* fileHandle = *get_payload<FileHandle*>(job);
                 // @NOTE :  This job should not be executed on render thread.
                 al_assert(!Renderer::get()->is_render_thread());
                 al_log_message(EngineConfig::RESOURCE_MANAGER_LOG_CATEGORY, "Loading mesh");
@@ -169,8 +169,10 @@ namespace al::engine
                     start_job(gRenderJobSystem, createRenderResourcesJob);
                 }
             });
-            set_after(postLoadJob, loadJob);
-            start_job(gMainJobSystem, postLoadJob);
+            // @NOTE :  Step 3. Start loading that resource. Post load job will be started on the main
+            //          job system when file is loaded
+            HandleJobPair loadResult = file_async_load(gFileSystem, path, FileLoadMode::READ, postLoadJob);
+            al_assert(loadResult.handle);
         }
         return handle;
     }
@@ -1,6 +1,8 @@
 
 #include "alfina_engine_application.h"
 
+#include <algorithm> // for std::sort
+
 #include "utilities/smooth_average.h"
 #include "utilities/constexpr_functions.h"
 
@@ -14,11 +16,14 @@ namespace al::engine
         construct(gLogger);
 
         gMainJobSystem = MemoryManager::get_stack()->allocate_as<JobSystem>();
-        construct(gMainJobSystem, get_number_of_job_system_threads());
+        construct(gMainJobSystem, get_number_of_job_system_threads(), true);
 
         gRenderJobSystem = MemoryManager::get_stack()->allocate_as<JobSystem>();
         construct(gRenderJobSystem, 0);
 
+        gIoJobSystem = MemoryManager::get_stack()->allocate_as<JobSystem>();
+        construct(gIoJobSystem, EngineConfig::IO_JOB_SYSTEM_THREADS);
+
         init_jobs();
 
         gFileSystem = MemoryManager::get_stack()->allocate_as<FileSystem>();
@@ -58,6 +63,9 @@ namespace al::engine
         ResourceManager::destruct();
         Renderer::destruct();
         destroy_window(window);
+        // @NOTE :  Io jobs use file system and push their continuations to the main job system,
+        //          so io job system must be destroyed first
+        destruct(gIoJobSystem);
         destruct(gFileSystem);
         destruct(gMainJobSystem);
         destruct(gRenderJobSystem);
@@ -151,8 +159,11 @@ namespace al::engine
     void AlfinaEngineApplication::process_end_frame() noexcept
     {
         al_profile_function();
+        // @NOTE :  Delivers events of immediate structural changes made during the frame
+        ecs_flush_observers(defaultEcsWorld);
         defaultScene->update_transforms();
         logger_flush_buffers(gLogger);
+        advance_frame(gMainJobSystem);
         frameCount++;
     }
 
@@ -178,42 +189,65 @@ namespace al::engine
     void AlfinaEngineApplication::distribute_threads_to_cpu_cores() noexcept
     {
         // Collect handles to all threads used by the program
+        // @NOTE :  Order matters - main and render threads are placed first, so they get separate physical cores
         ArrayContainer<ThreadHandle, EngineConfig::MAX_SUPPORTED_THREADS> threads{ };
         construct(&threads);
         push(&threads, get_current_thread_handle());
-        push(&threads, Renderer::get()->get_render_thread()->native_handle());
+        push(&threads, get_thread_handle(Renderer::get()->get_render_thread()));
         std::span<JobSystemThread> jobSystemThread = gMainJobSystem->threads;
         for (JobSystemThread& jobSystemThread : jobSystemThread)
         {
-            push(&threads, jobSystemThread.thread.native_handle());
+            push(&threads, get_thread_handle(&jobSystemThread.thread));
         }
-        // Get max number of threads supported by the user's computer
-        const std::size_t systemMaxThreads = std::thread::hardware_concurrency();
+        // Get system topology
+        CpuTopology topology;
+        query_cpu_topology(&topology);
+        const std::size_t systemMaxThreads = topology.logicalProcessors.size;
         // Get number of program threads
         const std::size_t programThreadsCount = threads.size;
         // Print warnings if needed
-        if (systemMaxThreads > EngineConfig::MAX_SUPPORTED_THREADS)
+        if (std::thread::hardware_concurrency() > EngineConfig::MAX_SUPPORTED_THREADS)
         {
-            al_log_warning(LOG_CATEGORY_BASE_APPLICATION, "Current system supports %d threads", systemMaxThreads);
+            al_log_warning(LOG_CATEGORY_BASE_APPLICATION, "Current system supports %d threads", std::thread::hardware_concurrency());
             al_log_warning(LOG_CATEGORY_BASE_APPLICATION, "This is more than engine currntly supports (%d threads)", EngineConfig::MAX_SUPPORTED_THREADS);
         }
-        if (programThreadsCount > EngineConfig::MAX_SUPPORTED_THREADS)
+        if (programThreadsCount > topology.physicalCoresNum)
         {
-            al_log_warning(LOG_CATEGORY_BASE_APPLICATION, "Using more threads than engine supports. Some threads will share the same cores");
+            al_log_warning(LOG_CATEGORY_BASE_APPLICATION, "Using more threads than system has physical cores. Some threads will share cores with SMT siblings");
         }
         if (programThreadsCount > systemMaxThreads)
         {
             al_log_warning(LOG_CATEGORY_BASE_APPLICATION, "Using more threads than system supports. Some threads will share the same cores");
         }
-        // Get max supported number of threads by the program
-        // If user's computer supports less than EngineConfig::MAX_SUPPORTED_THREADS threads, systemMaxThreads will be used
-        // If user's computer supports more than EngineConfig::MAX_SUPPORTED_THREADS threads, EngineConfig::MAX_SUPPORTED_THREADS will be used
-        const uint64_t maxThreads = minimum(systemMaxThreads, EngineConfig::MAX_SUPPORTED_THREADS);
-        for (uint64_t it = 0; it < programThreadsCount; it++)
+        if (systemMaxThreads == 0)
+        {
+            return;
+        }
+        // @NOTE :  Logical processors are ordered so that first SMT sibling of each physical core comes first
+        //          (cores which share last level cache are kept together), and only then second siblings and so on.
+        //          This way every thread gets it's own physical core while there are free cores left.
+        CpuLogicalProcessor* processors = topology.logicalProcessors.memory;
+        std::sort(processors, processors + systemMaxThreads, [](const CpuLogicalProcessor& first, const CpuLogicalProcessor& second) -> bool
+        {
+            if (first.smtIndex != second.smtIndex)
+            {
+                return first.smtIndex < second.smtIndex;
+            }
+            if (first.cacheDomainId != second.cacheDomainId)
+            {
+                return first.cacheDomainId < second.cacheDomainId;
+            }
+            return first.id < second.id;
+        });
+        for (std::size_t it = 0; it < programThreadsCount; it++)
+        {
+            const CpuLogicalProcessor* processor = &processors[it % systemMaxThreads];
+            set_thread_affinity_cpu(*get(&threads, it), processor->id);
+        }
+        // @NOTE :  Render and main job system threads raise their own priority when started
+        if (!set_current_thread_highest_priority())
         {
-            const uint64_t mask = uint64_t{1} << (it % maxThreads);
-            set_thread_affinity_mask(*get(&threads, it), mask);
-            set_thread_highest_priority(*get(&threads, it));
+            al_log_warning(LOG_CATEGORY_BASE_APPLICATION, "Can't raise priority of main thread");
         }
     }
 }
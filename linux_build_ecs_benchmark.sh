@@ -0,0 +1,7 @@
+#!/bin/sh
+
+c++ \
+-O2 -std=c++20 -pthread \
+benchmarks/ecs_benchmark.cpp \
+-I "." \
+-o ecs_benchmark
@@ -0,0 +1,7 @@
+#!/bin/sh
+
+c++ \
+-O2 -std=c++20 -pthread \
+benchmarks/job_system_benchmark.cpp \
+-I "." \
+-o job_system_benchmark
@@ -105,6 +105,17 @@ namespace al
 		return crc_private::crc32(data);
 	}
 	
+	// @NOTE :  64 bit FNV-1a hash
+	constexpr uint64_t fnv1a_64(const char* data, std::size_t size) noexcept
+	{
+		uint64_t hash = 0xcbf29ce484222325ULL;
+		for (std::size_t it = 0; it < size; ++it)
+		{
+			hash = (hash ^ static_cast<uint8_t>(data[it])) * 0x100000001b3ULL;
+		}
+		return hash;
+	}
+
 	template<typename T>
 	constexpr bool is_equal(T value1, T value2, T precision = std::numeric_limits<T>::epsilon()) noexcept
 	{
@@ -239,6 +250,19 @@ namespace al
         return (value & (value - T{1})) == 0;
     }
 
+    // @NOTE :  Alignment must be power of two
+    template<std::unsigned_integral T>
+    constexpr T align_up(T value, T alignment) noexcept
+    {
+        return (value + alignment - T{1}) & ~(alignment - T{1});
+    }
+
+    template<std::unsigned_integral T>
+    constexpr T lowest_set_bit(T value) noexcept
+    {
+        return value & (~value + T{1});
+    }
+
     template<typename T>
     constexpr T minimum(const T& first, const T& second) noexcept
     {
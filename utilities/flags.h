@@ -2,6 +2,16 @@
 #define AL_FLAGS_H
 
 #include <cstdint>
+#include <cstddef>  // for std::size_t
+#include <bit>      // for std::popcount, std::countr_zero
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#   define AL_FLAGS_USE_SSE2
+#   include <emmintrin.h>
+#endif
+
+// @NOTE :  Iterates over indices of set flags of FlagsWide in ascending order
+#define for_each_set_flag(flagsValue, it) for (uint64_t it = (flagsValue).find_next_flag(0); it < (flagsValue).BITS_NUM; it = (flagsValue).find_next_flag(it + 1))
 
 namespace al
 {
@@ -63,6 +73,11 @@ namespace al
             flags[0] = flags[1] = 0;
         }
 
+        inline uint64_t count() const noexcept
+        {
+            return std::popcount(flags[0]) + std::popcount(flags[1]);
+        }
+
         bool operator == (const Flags128& other) const noexcept
         {
             return (flags[0] == other.flags[0]) && (flags[1] == other.flags[1]);
@@ -70,6 +85,188 @@ namespace al
 
         uint64_t flags[2];
     };
+
+    // @NOTE :  Bitset of configurable width (multiple of 128 bits). Subset, intersection and equality
+    //          tests process 128 bits at once with SSE2 (scalar code is used on other targets).
+    template<std::size_t BITS>
+    struct FlagsWide
+    {
+        static_assert(BITS % 128 == 0, "FlagsWide width must be multiple of 128 bits");
+
+        static constexpr std::size_t BITS_NUM   = BITS;
+        static constexpr std::size_t WORDS_NUM  = BITS / 64;
+
+        inline void set_flag(uint64_t flag) noexcept
+        {
+            flags[flag / 64] |= 1ULL << (flag % 64);
+        }
+
+        inline bool get_flag(uint64_t flag) const noexcept
+        {
+            return static_cast<bool>(flags[flag / 64] & (1ULL << (flag % 64)));
+        }
+
+        inline void clear_flag(uint64_t flag) noexcept
+        {
+            flags[flag / 64] &= ~(1ULL << (flag % 64));
+        }
+
+        inline void clear() noexcept
+        {
+            for (std::size_t it = 0; it < WORDS_NUM; it++)
+            {
+                flags[it] = 0;
+            }
+        }
+
+        inline uint64_t count() const noexcept
+        {
+            uint64_t result = 0;
+            for (std::size_t it = 0; it < WORDS_NUM; it++)
+            {
+                result += std::popcount(flags[it]);
+            }
+            return result;
+        }
+
+        // @NOTE :  Number of set flags with index lower than flag
+        inline uint64_t count_below(uint64_t flag) const noexcept
+        {
+            uint64_t result = 0;
+            for (std::size_t it = 0; it < flag / 64; it++)
+            {
+                result += std::popcount(flags[it]);
+            }
+            return result + std::popcount(flags[flag / 64] & ((1ULL << (flag % 64)) - 1));
+        }
+
+        // @NOTE :  Returns index of the first set flag which is not lower than from, or BITS_NUM if there is no such flag
+        inline uint64_t find_next_flag(uint64_t from) const noexcept
+        {
+            for (std::size_t it = from / 64; it < WORDS_NUM; it++)
+            {
+                const uint64_t word = it == from / 64 ? flags[it] & (~0ULL << (from % 64)) : flags[it];
+                if (word)
+                {
+                    return it * 64 + std::countr_zero(word);
+                }
+            }
+            return BITS_NUM;
+        }
+
+        inline bool is_empty() const noexcept
+        {
+            return *this == FlagsWide{ };
+        }
+
+        bool is_subset_of(const FlagsWide& other) const noexcept
+        {
+#ifdef AL_FLAGS_USE_SSE2
+            for (std::size_t it = 0; it < WORDS_NUM; it += 2)
+            {
+                const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(flags + it));
+                const __m128i otherValue = _mm_loadu_si128(reinterpret_cast<const __m128i*>(other.flags + it));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(value, otherValue), value)) != 0xFFFF)
+                {
+                    return false;
+                }
+            }
+            return true;
+#else
+            for (std::size_t it = 0; it < WORDS_NUM; it++)
+            {
+                if ((flags[it] & other.flags[it]) != flags[it])
+                {
+                    return false;
+                }
+            }
+            return true;
+#endif
+        }
+
+        bool intersects(const FlagsWide& other) const noexcept
+        {
+#ifdef AL_FLAGS_USE_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            for (std::size_t it = 0; it < WORDS_NUM; it += 2)
+            {
+                const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(flags + it));
+                const __m128i otherValue = _mm_loadu_si128(reinterpret_cast<const __m128i*>(other.flags + it));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(value, otherValue), zero)) != 0xFFFF)
+                {
+                    return true;
+                }
+            }
+            return false;
+#else
+            for (std::size_t it = 0; it < WORDS_NUM; it++)
+            {
+                if (flags[it] & other.flags[it])
+                {
+                    return true;
+                }
+            }
+            return false;
+#endif
+        }
+
+        bool operator == (const FlagsWide& other) const noexcept
+        {
+#ifdef AL_FLAGS_USE_SSE2
+            for (std::size_t it = 0; it < WORDS_NUM; it += 2)
+            {
+                const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(flags + it));
+                const __m128i otherValue = _mm_loadu_si128(reinterpret_cast<const __m128i*>(other.flags + it));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(value, otherValue)) != 0xFFFF)
+                {
+                    return false;
+                }
+            }
+            return true;
+#else
+            for (std::size_t it = 0; it < WORDS_NUM; it++)
+            {
+                if (flags[it] != other.flags[it])
+                {
+                    return false;
+                }
+            }
+            return true;
+#endif
+        }
+
+        FlagsWide operator & (const FlagsWide& other) const noexcept
+        {
+            FlagsWide result;
+            for (std::size_t it = 0; it < WORDS_NUM; it++)
+            {
+                result.flags[it] = flags[it] & other.flags[it];
+            }
+            return result;
+        }
+
+        FlagsWide operator | (const FlagsWide& other) const noexcept
+        {
+            FlagsWide result;
+            for (std::size_t it = 0; it < WORDS_NUM; it++)
+            {
+                result.flags[it] = flags[it] | other.flags[it];
+            }
+            return result;
+        }
+
+        FlagsWide operator ~ () const noexcept
+        {
+            FlagsWide result;
+            for (std::size_t it = 0; it < WORDS_NUM; it++)
+            {
+                result.flags[it] = ~flags[it];
+            }
+            return result;
+        }
+
+        uint64_t flags[WORDS_NUM] = { };
+    };
 }
 
 #endif
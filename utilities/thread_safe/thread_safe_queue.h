@@ -83,6 +83,34 @@ namespace al
             return true;
         }
 
+        // @NOTE :  Reserves count contiguous cells with a single atomic add
+        //          instead of doing CAS for each element. Unlike enqueue this
+        //          method can't report that queue is full - it waits for consumers
+        //          to free reserved cells, so user must guarantee that number of
+        //          elements in the queue never exceeds it's capacity.
+        void enqueue_bulk(const T* data, std::size_t count) noexcept
+        {
+            if (count == 0)
+            {
+                return;
+            }
+            // Reserve range of positions
+            const std::size_t firstPos = enqueuePos.fetch_add(count, std::memory_order_relaxed);
+            for (std::size_t it = 0; it < count; it++)
+            {
+                const std::size_t pos = firstPos + it;
+                // Get current cell
+                Cell* cell = &buffer[pos & bufferMask];
+                // Wait until cell is ready for write
+                while (cell->sequence.load(std::memory_order_acquire) != pos)
+                { }
+                // Write data
+                cell->data = data[it];
+                // Update sequence
+                cell->sequence.store(pos + 1, std::memory_order_release);
+            }
+        }
+
         bool dequeue(T* data) noexcept
         {
             Cell* cell;